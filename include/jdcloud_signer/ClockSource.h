@@ -0,0 +1,43 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+namespace jdcloud_signer {
+
+/**
+ * Where a signer reads the signing time from. Signatures only carry whole seconds, so the cheaper sources lose
+ * nothing as long as the system clock itself is right.
+ */
+enum class ClockSource
+{
+    /**
+     * std::chrono::system_clock, read for every request.
+     */
+    Precise,
+
+    /**
+     * CLOCK_REALTIME_COARSE where available (Linux), which is served from the vDSO without reading the hardware
+     * clock. Falls back to Precise elsewhere.
+     */
+    Coarse,
+
+    /**
+     * The current second kept in memory by a background thread that ticks once a second. Reading it is a single
+     * atomic load. The thread starts on first use and is restarted in a forked child.
+     */
+    CachedSecond
+};
+
+}
@@ -16,24 +16,73 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <memory>
 #include <string>
+#include <vector>
+#include "jdcloud_signer/ClockSource.h"
 #include "jdcloud_signer/Credential.h"
+#include "jdcloud_signer/PreparedRequest.h"
 #include "jdcloud_signer/http/HttpRequest.h"
 
 namespace jdcloud_signer {
 
+class JdcloudSignerImpl;
+
+/**
+ * Signs requests for one credential, service and region. All per-signer state is built once at construction,
+ * so keep the signer around and reuse it. It is safe to call SignRequest from many threads at once.
+ */
 class JdcloudSigner
 {
 public:
     JdcloudSigner(const Credential& credential, const std::string& serviceName, const std::string& region);
 
+    /**
+     * Same as above, reading the signing time from clockSource. Under heavy multi-threaded signing
+     * ClockSource::CachedSecond keeps the clock off the hot path.
+     */
+    JdcloudSigner(const Credential& credential, const std::string& serviceName, const std::string& region,
+                  ClockSource clockSource);
+
     virtual ~JdcloudSigner();
 
     bool SignRequest(HttpRequest& request) const;
+
+    /**
+     * Canonicalizes the path, query string and signed headers of a template request once, for signing many
+     * requests of the same shape. See PreparedRequest.
+     */
+    PreparedRequest PrepareRequest(const HttpRequest& request) const;
+
+    /**
+     * Signs request reusing what prepared already canonicalized. Gives the same signature as SignRequest(request).
+     */
+    bool SignRequest(HttpRequest& request, const PreparedRequest& prepared) const;
+
+    /**
+     * Signs a contiguous range of requests. They share the signing timestamp and derived key, so this is cheaper
+     * than signing them one by one. Returns whether each request was signed.
+     */
+    std::vector<bool> SignRequests(HttpRequest* requests, size_t count) const;
+
+    std::vector<bool> SignRequests(std::vector<HttpRequest>& requests) const;
+
+    /**
+     * Signs a range of requests on threadCount threads, the calling thread included. Threads that run out of
+     * requests take over part of the remaining ones, so batches mixing small and large bodies still keep every
+     * thread busy. Worth it for large batches only.
+     */
+    std::vector<bool> SignRequests(HttpRequest* requests, size_t count, size_t threadCount) const;
+
+    std::vector<bool> SignRequests(std::vector<HttpRequest>& requests, size_t threadCount) const;
+
+    /**
+     * The length of a body of payloadLength bytes once it is framed for PayloadSigning::STREAMING.
+     */
+    static uint64_t GetStreamingContentLength(uint64_t payloadLength);
 private:
-    Credential m_credential;
-    std::string m_serviceName;
-    std::string m_region;
+    std::shared_ptr<const JdcloudSignerImpl> m_impl;
 };
 
 }
@@ -0,0 +1,60 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace jdcloud_signer {
+
+class JdcloudSignerImpl;
+
+/**
+ * The parts of a request that stay the same from one call of an endpoint to the next, canonicalized once: the
+ * encoded path, the sorted query string and the signed headers. Built by JdcloudSigner::PrepareRequest from a
+ * template request and passed along with each instance to JdcloudSigner::SignRequest, which then only has to
+ * canonicalize what differs from the template (date, nonce and any other header whose value changed).
+ *
+ * Instances do not have to match the template, anything that differs is canonicalized as usual and the signature
+ * is always the same as without the prepared request. Immutable once built, share it between threads freely.
+ */
+class PreparedRequest
+{
+public:
+    /**
+     * Number of headers whose canonical form is cached.
+     */
+    inline size_t GetPreparedHeaderCount() const { return m_headers.size(); }
+
+private:
+    friend class JdcloudSignerImpl;
+
+    struct Header
+    {
+        std::string name;
+        std::string value;
+        std::string canonicalValue;
+    };
+
+    std::string m_path;
+    std::string m_encodedPath;
+    std::string m_queryString;
+    std::string m_canonicalQueryString;
+    // in header name order, as the request keeps them.
+    std::vector<Header> m_headers;
+};
+
+}
@@ -0,0 +1,101 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace jdcloud_signer {
+
+/**
+ * Non owning view of a character range, a minimal std::string_view for C++11. The viewed characters must outlive it.
+ */
+class StringView
+{
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    StringView() : m_data(""), m_size(0) {}
+    StringView(const char* data, size_t size) : m_data(data), m_size(size) {}
+    StringView(const char* str) : m_data(str), m_size(std::strlen(str)) {}
+    StringView(const std::string& str) : m_data(str.data()), m_size(str.size()) {}
+
+    inline const char* data() const { return m_data; }
+    inline size_t size() const { return m_size; }
+    inline size_t length() const { return m_size; }
+    inline bool empty() const { return m_size == 0; }
+    inline const char* begin() const { return m_data; }
+    inline const char* end() const { return m_data + m_size; }
+    inline char operator[](size_t pos) const { return m_data[pos]; }
+    inline char front() const { return m_data[0]; }
+    inline char back() const { return m_data[m_size - 1]; }
+
+    inline StringView substr(size_t pos, size_t count = npos) const
+    {
+        if (pos > m_size)
+        {
+            pos = m_size;
+        }
+        if (count > m_size - pos)
+        {
+            count = m_size - pos;
+        }
+        return StringView(m_data + pos, count);
+    }
+
+    inline size_t find(char c, size_t pos = 0) const
+    {
+        if (pos >= m_size)
+        {
+            return npos;
+        }
+        const void* found = std::memchr(m_data + pos, c, m_size - pos);
+        return found ? static_cast<size_t>(static_cast<const char*>(found) - m_data) : npos;
+    }
+
+    inline int compare(const StringView& other) const
+    {
+        size_t common = m_size < other.m_size ? m_size : other.m_size;
+        int result = common == 0 ? 0 : std::memcmp(m_data, other.m_data, common);
+        if (result != 0)
+        {
+            return result;
+        }
+        return m_size < other.m_size ? -1 : (m_size > other.m_size ? 1 : 0);
+    }
+
+    inline std::string ToString() const { return std::string(m_data, m_size); }
+
+private:
+    const char* m_data;
+    size_t m_size;
+};
+
+inline bool operator==(const StringView& a, const StringView& b)
+{
+    return a.size() == b.size() && (a.size() == 0 || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+inline bool operator!=(const StringView& a, const StringView& b) { return !(a == b); }
+inline bool operator<(const StringView& a, const StringView& b) { return a.compare(b) < 0; }
+
+inline std::ostream& operator<<(std::ostream& stream, const StringView& view)
+{
+    return stream.write(view.data(), static_cast<std::streamsize>(view.size()));
+}
+
+}
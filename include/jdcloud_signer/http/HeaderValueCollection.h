@@ -0,0 +1,127 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "jdcloud_signer/StringView.h"
+
+namespace jdcloud_signer {
+
+typedef std::pair<std::string, std::string> HeaderValuePair;
+
+/**
+ * A header as kept by HeaderValueCollection: the name and value, plus the canonical form of the value that goes
+ * into signatures. The canonical form is computed whenever the value is written and changes, so signing the same
+ * request again canonicalizes nothing, and reading it is as thread safe as reading the value.
+ */
+class HeaderValueEntry : public HeaderValuePair
+{
+public:
+    HeaderValueEntry();
+    HeaderValueEntry(std::string&& name, std::string&& value);
+
+    /**
+     * The value trimmed, with its lines joined by commas and runs of spaces collapsed. Like reading the value,
+     * not safe while another thread modifies the collection.
+     */
+    inline const std::string& GetCanonicalValue() const { return m_valueIsCanonical ? second : m_canonicalValue; }
+
+    /**
+     * Replaces the value. Setting the value it already has keeps the canonical form.
+     */
+    void SetValue(std::string&& value);
+
+    /**
+     * Replaces the value with a copy of value, reusing the capacity of the old one.
+     */
+    void SetValue(StringView value);
+
+    /**
+     * Canonicalizes value as GetCanonicalValue does, into out. One pass over value that reuses the capacity of
+     * out, so nothing is allocated once out has grown to fit.
+     */
+    static void CanonicalizeValue(StringView value, std::string& out);
+
+    static std::string CanonicalizeValue(const std::string& value);
+
+    /**
+     * Whether value is its own canonical form, which is the usual case.
+     */
+    static bool IsCanonicalValue(StringView value);
+
+private:
+    void UpdateCanonicalValue();
+
+    std::string m_canonicalValue;
+    // the value is canonical already, which is the usual case, and m_canonicalValue is not used.
+    bool m_valueIsCanonical;
+};
+
+/**
+ * The headers of a request, kept in one flat array sorted by name so that walking them in order touches
+ * contiguous memory. The first INLINE_CAPACITY headers live inside the collection itself, only requests with more
+ * headers than that move them to the heap. Names are compared byte by byte, callers lowercase them first.
+ */
+class HeaderValueCollection
+{
+public:
+    typedef HeaderValueEntry value_type;
+    typedef const HeaderValueEntry* const_iterator;
+    typedef const_iterator iterator;
+
+    static const size_t INLINE_CAPACITY = 16;
+
+    HeaderValueCollection();
+
+    inline const_iterator begin() const { return Data(); }
+    inline const_iterator end() const { return Data() + size(); }
+    inline const_iterator cbegin() const { return begin(); }
+    inline const_iterator cend() const { return end(); }
+    inline size_t size() const { return m_overflow.empty() ? m_size : m_overflow.size(); }
+    inline bool empty() const { return size() == 0; }
+
+    /**
+     * The header named name, or end() when there is none.
+     */
+    const_iterator find(StringView name) const;
+
+    /**
+     * Sets the value of the header named name, adding it in order if it is not there yet. value is copied only
+     * when it differs from the one the header already has.
+     */
+    void Set(std::string&& name, StringView value);
+
+    /**
+     * Removes the header named name. Returns whether there was one.
+     */
+    bool erase(StringView name);
+
+    void clear();
+
+private:
+    inline const HeaderValueEntry* Data() const { return m_overflow.empty() ? m_inline : m_overflow.data(); }
+    inline HeaderValueEntry* Data() { return m_overflow.empty() ? m_inline : m_overflow.data(); }
+    size_t LowerBound(StringView name) const;
+
+    HeaderValueEntry m_inline[INLINE_CAPACITY];
+    size_t m_size;
+    // holds all the headers once there are more than fit inline, m_inline is unused then.
+    std::vector<HeaderValueEntry> m_overflow;
+};
+
+}
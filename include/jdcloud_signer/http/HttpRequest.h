@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include "jdcloud_signer/http/URI.h"
@@ -29,6 +30,10 @@ extern const char* AUTHORIZATION_HEADER;
 extern const char* CONTENT_TYPE_HEADER;
 extern const char* USER_AGENT_HEADER;
 extern const char* HOST_HEADER;
+extern const char* CONTENT_SHA256_HEADER;
+extern const char* CONTENT_LENGTH_HEADER;
+extern const char* CONTENT_ENCODING_HEADER;
+extern const char* DECODED_CONTENT_LENGTH_HEADER;
 
 class HttpRequest
 {
@@ -67,14 +72,14 @@ public:
     /**
      * Gets the query string from the URI on this request.
      */
-    inline const std::string& GetQueryString() const
+    inline StringView GetQueryString() const
     {
         return m_uri.GetQueryString();
     }
     /**
-     * Get All headers for this request.
+     * Get All headers for this request, in name order. Valid until the headers are modified.
      */
-    HeaderValueCollection GetHeaders() const;
+    inline const HeaderValueCollection& GetHeaders() const { return headerMap; }
     /**
      * Get the value for a Header based on its name.
      */
@@ -93,12 +98,38 @@ public:
     void DeleteHeader(const char* headerName);
     /**
      * Adds a content body stream to the request. This stream will be used to send the body to the endpoint.
+     * Forgets the payload hash of the previous body, so call it again after changing the stream in place.
      */
-    inline void AddContentBody(const std::shared_ptr<std::iostream>& strContent) { bodyStream = strContent; }
+    inline void AddContentBody(const std::shared_ptr<std::iostream>& strContent)
+    {
+        bodyStream = strContent;
+        ++m_bodyGeneration;
+    }
     /**
      * Gets the content body stream that will be used for this request.
      */
     inline const std::shared_ptr<std::iostream>& GetContentBody() const { return bodyStream; }
+    /**
+     * Counts the calls to AddContentBody, so the payload hash can be tied to the body it was computed for.
+     */
+    inline uint64_t GetContentBodyGeneration() const { return m_bodyGeneration; }
+    /**
+     * Sets the hex sha256 of the current content body, when the caller already knows it. Signing uses it instead
+     * of reading the body, and remembers the hash it computes the same way, so re-signing does not read it again.
+     */
+    void SetPayloadHash(const std::string& payloadHash);
+    /**
+     * The hex sha256 of the current content body, or an empty string when it is not known yet.
+     */
+    inline const std::string& GetPayloadHash() const
+    {
+        return m_payloadHashGeneration == m_bodyGeneration ? m_payloadHash : m_emptyHeader;
+    }
+    /**
+     * Whether the signature covers the content body, PayloadSigning::SIGNED unless set otherwise.
+     */
+    inline void SetPayloadSigning(PayloadSigning payloadSigning) { m_payloadSigning = payloadSigning; }
+    inline PayloadSigning GetPayloadSigning() const { return m_payloadSigning; }
     /**
      * Returns true if a header exists in the request with name
      */
@@ -127,6 +158,10 @@ private:
     HttpMethod m_method;
     HeaderValueCollection headerMap;
     std::shared_ptr<std::iostream> bodyStream;
+    uint64_t m_bodyGeneration;
+    std::string m_payloadHash;
+    uint64_t m_payloadHashGeneration;
+    PayloadSigning m_payloadSigning;
     static const std::string m_emptyHeader;
 };
 
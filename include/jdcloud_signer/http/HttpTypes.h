@@ -17,7 +17,7 @@
 #pragma once
 
 #include <string>
-#include <map>
+#include "jdcloud_signer/http/HeaderValueCollection.h"
 
 namespace jdcloud_signer {
 
@@ -34,6 +34,33 @@ enum class HttpMethod
     HTTP_PATCH
 };
 
+/**
+ * What the signature says about the request body.
+ */
+enum class PayloadSigning
+{
+    /**
+     * The sha256 of the body, which is read once to compute it.
+     */
+    SIGNED,
+    /**
+     * The UNSIGNED-PAYLOAD marker. The body is never read, so signing takes the same time whatever its size.
+     * Only for services that accept it, over TLS.
+     */
+    UNSIGNED,
+    /**
+     * The STREAMING-JDCLOUD2-HMAC-SHA256-PAYLOAD marker, also sent in the x-jdcloud-content-sha256 header. Signing
+     * replaces the body with one that frames and signs it chunk by chunk while it is sent, chaining the chunk
+     * signatures to the request signature. A request without a body is signed as SIGNED.
+     *
+     * The length of the body has to be known: the body is either seekable, and sent from its start, or the
+     * caller sets x-jdcloud-decoded-content-length to the number of bytes left in it. Signing fails otherwise.
+     * The signer sets and signs x-jdcloud-decoded-content-length, Content-Length to the framed length (see
+     * JdcloudSigner::GetStreamingContentLength) and puts jdcloud-chunked first in Content-Encoding.
+     */
+    STREAMING
+};
+
 namespace HttpMethodMapper
 {
     /**
@@ -42,7 +69,4 @@ namespace HttpMethodMapper
     const char *GetNameForHttpMethod(HttpMethod httpMethod);
 }
 
-typedef std::pair<std::string, std::string> HeaderValuePair;
-typedef std::map<std::string, std::string> HeaderValueCollection;
-
 }
@@ -19,6 +19,7 @@
 #include <stdint.h>
 #include <string>
 #include <map>
+#include "jdcloud_signer/StringView.h"
 #include "jdcloud_signer/http/Scheme.h"
 
 namespace jdcloud_signer {
@@ -33,6 +34,9 @@ typedef std::map<std::string, std::string> QueryStringParameterCollection;
 
 /**
  * class modeling universal resource identifier, but implemented for http
+ *
+ * The authority, path and query string are kept one after the other in a single buffer and handed out as views
+ * into it. A view is valid until the URI is modified.
  */
 class URI
 {
@@ -73,12 +77,12 @@ public:
     /**
      * Gets the domain portion of the uri
      */
-    inline const std::string& GetAuthority() const { return m_authority; }
+    inline StringView GetAuthority() const { return Segment(0, m_pathBegin); }
 
     /**
      * Sets the domain portion of the uri
      */
-    inline void SetAuthority(const std::string& value) { m_authority = value; }
+    void SetAuthority(const std::string& value);
 
     /**
      * Gets the port portion of the uri, defaults to 22 for ftp, 80 for http and 443 for https
@@ -95,12 +99,21 @@ public:
      * Gets the path portion of the uri e.g. the portion after the first slash after the authority and prior to the
      * query string. This is not url encoded.
      */
-    inline const std::string& GetPath() const { return m_path; }
+    inline StringView GetPath() const { return Segment(m_pathBegin, m_queryBegin); }
 
     /**
      * Gets the path portion of the uri, url encodes it and returns it
      */
-    inline std::string GetURLEncodedPath() const { return URLEncodePath(m_path); }
+    inline std::string GetURLEncodedPath() const { return URLEncodePath(GetPath()); }
+
+    /**
+     * Writes the url encoded path to encoded, replacing its contents.
+     */
+    inline void GetURLEncodedPath(std::string& encoded) const
+    {
+        encoded.clear();
+        URLEncodePath(GetPath(), encoded);
+    }
 
     /**
      * Sets the path portion of the uri. URL encodes it if needed
@@ -110,7 +123,7 @@ public:
     /**
      * Gets the raw query string including the ?
      */
-    inline const std::string& GetQueryString() const { return m_queryString; }
+    inline StringView GetQueryString() const { return Segment(m_queryBegin, m_buffer.size()); }
 
     /**
      * Resets the query string to the raw string. all query string manipulations made before this call will be lost
@@ -120,7 +133,7 @@ public:
     std::string GetFormParameters() const;
 
     /**
-     * Cannonicalizes the query string.
+     * Cannonicalizes the query string: parameters sorted by key, repeated keys all kept and sorted by value.
      */
     void CanonicalizeQueryString();
 
@@ -148,28 +161,40 @@ public:
     /**
      * URLEncodes the path portions of path (doesn't encode the "/" portion)
      */
-    static std::string URLEncodePath(const std::string& path);
+    static std::string URLEncodePath(StringView path);
+
+    /**
+     * Same as above, appending to encoded.
+     */
+    static void URLEncodePath(StringView path, std::string& encoded);
 
     /**
      * URLEncodes the path portion of the URI according to RFC3986
      */
-    static std::string URLEncodePathRFC3986(const std::string& path);
+    static std::string URLEncodePathRFC3986(StringView path);
+
+    /**
+     * Same as above, appending to encoded.
+     */
+    static void URLEncodePathRFC3986(StringView path, std::string& encoded);
 
 
 private:
-    void ParseURIParts(const std::string& uri);
-    void ExtractAndSetScheme(const std::string& uri);
-    void ExtractAndSetAuthority(const std::string& uri);
-    void ExtractAndSetPort(const std::string& uri);
-    void ExtractAndSetPath(const std::string& uri);
-    void ExtractAndSetQueryString(const std::string& uri);
+    inline StringView Segment(size_t begin, size_t end) const
+    {
+        return StringView(m_buffer.data() + begin, end - begin);
+    }
+
+    void ParseURIParts(StringView uri);
+    void SetParts(StringView authority, StringView path, StringView queryString);
     bool CompareURIParts(const URI& other) const;
 
     Scheme m_scheme;
-    std::string m_authority;
     uint16_t m_port;
-    std::string m_path;
-    std::string m_queryString;
+    // authority, path and query string, in this order.
+    std::string m_buffer;
+    size_t m_pathBegin;
+    size_t m_queryBegin;
 };
 
 }
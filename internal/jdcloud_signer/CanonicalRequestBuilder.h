@@ -0,0 +1,123 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "jdcloud_signer/StringView.h"
+#include "jdcloud_signer/util/crypto/Sha256.h"
+
+namespace jdcloud_signer {
+
+/**
+ * Writes the canonical request, the string to sign and the Authorization value of one signature into a single
+ * buffer, one after the other. Calling BeginCanonicalRequest starts over but keeps the capacity, so once the
+ * buffer has grown to fit the usual request a builder signs without allocating. Not thread safe, keep one per
+ * thread.
+ *
+ * Given a digest, the canonical request is hashed as it is produced instead: it goes through a small staging area
+ * into the digest and is only kept in full when asked to, e.g. for debug logging.
+ */
+class CanonicalRequestBuilder
+{
+public:
+    static const size_t INITIAL_CAPACITY = 2048;
+    static const size_t STAGING_CAPACITY = 4096;
+
+    CanonicalRequestBuilder();
+
+    /**
+     * Starts a canonical request with the method, the encoded path and the query string (with its leading '?').
+     * When digest is set the canonical request is fed to it (Begin is called here, Finish is left to the caller
+     * after EndCanonicalRequest) and only kept if keepCanonicalRequest is true.
+     */
+    void BeginCanonicalRequest(StringView method, StringView encodedPath, StringView queryString,
+                               Sha256* digest = nullptr, bool keepCanonicalRequest = true);
+
+    /**
+     * Appends a canonical header line and adds its name to the signed headers. Call in header name order.
+     */
+    void AppendHeader(StringView name, StringView value);
+
+    /**
+     * Appends the signed headers list and the payload hash, ending the canonical request.
+     */
+    void EndCanonicalRequest(StringView payloadHash);
+
+    void BuildStringToSign(StringView algorithm, StringView dateValue, StringView credentialScope,
+                           StringView canonicalRequestHash);
+
+    void BuildAuthorization(StringView algorithm, StringView accessKey, StringView credentialScope,
+                            StringView signature);
+
+    /**
+     * Empty when the canonical request was streamed to a digest and not kept.
+     */
+    inline StringView GetCanonicalRequest() const { return Segment(m_canonicalRequestBegin, m_canonicalRequestEnd); }
+    inline StringView GetSignedHeaders() const { return Segment(m_signedHeadersBegin, m_signedHeadersEnd); }
+    inline StringView GetStringToSign() const { return Segment(m_stringToSignBegin, m_stringToSignEnd); }
+    inline StringView GetAuthorization() const { return Segment(m_authorizationBegin, m_buffer.size()); }
+
+private:
+    inline StringView Segment(size_t begin, size_t end) const
+    {
+        return StringView(m_buffer.data() + begin, end - begin);
+    }
+
+    inline void Append(StringView value) { m_buffer.append(value.data(), value.size()); }
+    inline void Append(char c) { m_buffer.push_back(c); }
+
+    /**
+     * Writes canonical request bytes, into the buffer or through the staging area into the digest.
+     */
+    inline void Write(StringView value)
+    {
+        if (m_streaming)
+        {
+            if (m_staging.size() + value.size() > STAGING_CAPACITY)
+            {
+                Flush();
+            }
+            if (value.size() >= STAGING_CAPACITY)
+            {
+                m_digest->Update(value.data(), value.size());
+                return;
+            }
+            m_staging.append(value.data(), value.size());
+        }
+        else
+        {
+            Append(value);
+        }
+    }
+    inline void Write(char c) { Write(StringView(&c, 1)); }
+    void Flush();
+
+    std::string m_buffer;
+    std::string m_staging;
+    std::vector<std::pair<size_t, size_t>> m_headerNames;
+    Sha256* m_digest;
+    bool m_streaming;
+    size_t m_canonicalRequestBegin;
+    size_t m_signedHeadersBegin;
+    size_t m_signedHeadersEnd;
+    size_t m_canonicalRequestEnd;
+    size_t m_stringToSignBegin;
+    size_t m_stringToSignEnd;
+    size_t m_authorizationBegin;
+};
+
+}
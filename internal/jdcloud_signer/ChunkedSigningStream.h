@@ -0,0 +1,103 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <stdint.h>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "jdcloud_signer/StringView.h"
+#include "jdcloud_signer/util/crypto/Sha256.h"
+#include "jdcloud_signer/util/crypto/Sha256Digest.h"
+#include "jdcloud_signer/util/crypto/Sha256HMACMidstate.h"
+
+namespace jdcloud_signer {
+
+/**
+ * Reads a body in chunks and hands each one out framed and signed, as PayloadSigning::STREAMING sends it:
+ *
+ *     <hex size>;chunk-signature=<signature>\r\n<data>\r\n
+ *
+ * ending with an empty chunk. A chunk is signed with the request's signing key over its hash and the signature of
+ * the chunk before it, the first one chaining to the request signature. Chunks are read, hashed and signed only
+ * when the reader gets to them, so memory stays at about two chunks and hashing overlaps with sending.
+ *
+ * Seeking back to the start reads the source again from its start; other seeks fail.
+ */
+class ChunkedSigningStreambuf : public std::streambuf
+{
+public:
+    static const size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    ChunkedSigningStreambuf(const std::shared_ptr<std::iostream>& source, StringView dateHeaderValue,
+                            StringView credentialScope, const Sha256HMACMidstate& signingKey,
+                            const Sha256HexDigest& seedSignature, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+    inline const std::shared_ptr<std::iostream>& GetSource() const { return m_source; }
+
+    /**
+     * The length of the framed body for payloadLength bytes of payload, for the Content-Length header.
+     */
+    static uint64_t GetEncodedLength(uint64_t payloadLength, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+protected:
+    int_type underflow() override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which = std::ios_base::in | std::ios_base::out) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in | std::ios_base::out) override;
+
+private:
+    bool NextChunk();
+    bool Rewind();
+
+    std::shared_ptr<std::iostream> m_source;
+    std::string m_dateHeaderValue;
+    std::string m_credentialScope;
+    Sha256HMACMidstate m_signingKey;
+    Sha256HexDigest m_seedSignature;
+    Sha256HexDigest m_previousSignature;
+    size_t m_chunkSize;
+    std::vector<char> m_payload;
+    std::string m_stringToSign;
+    std::string m_encoded;
+    Sha256 m_hash;
+    uint64_t m_encodedBefore;
+    bool m_finished;
+};
+
+/**
+ * A stream over a ChunkedSigningStreambuf, what the signer puts in place of a streamed body.
+ */
+class ChunkedSigningStream : public std::iostream
+{
+public:
+    ChunkedSigningStream(const std::shared_ptr<std::iostream>& source, StringView dateHeaderValue,
+                         StringView credentialScope, const Sha256HMACMidstate& signingKey,
+                         const Sha256HexDigest& seedSignature,
+                         size_t chunkSize = ChunkedSigningStreambuf::DEFAULT_CHUNK_SIZE);
+
+    /**
+     * The body being chunked.
+     */
+    inline const std::shared_ptr<std::iostream>& GetSource() const { return m_buffer.GetSource(); }
+
+private:
+    ChunkedSigningStreambuf m_buffer;
+};
+
+}
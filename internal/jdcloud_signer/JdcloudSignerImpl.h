@@ -19,10 +19,14 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include "jdcloud_signer/CanonicalRequestBuilder.h"
 #include "jdcloud_signer/Credential.h"
+#include "jdcloud_signer/PreparedRequest.h"
+#include "jdcloud_signer/SigningKeyCache.h"
 #include "jdcloud_signer/util/crypto/Sha256.h"
 #include "jdcloud_signer/util/crypto/Sha256HMAC.h"
 #include "jdcloud_signer/util/DateTime.h"
@@ -30,34 +34,85 @@
 
 namespace jdcloud_signer {
 
+/**
+ * The signing engine behind JdcloudSigner. Everything that does not depend on the request is set up in the
+ * constructor and never modified afterwards, so one instance can sign requests on many threads at once.
+ */
 class JdcloudSignerImpl
 {
 public:
-    JdcloudSignerImpl(const Credential& credential, const std::string& serviceName, const std::string& region);
+    JdcloudSignerImpl(const Credential& credential, const std::string& serviceName, const std::string& region,
+                      ClockSource clockSource = ClockSource::Precise);
 
     virtual ~JdcloudSignerImpl();
 
     bool SignRequest(HttpRequest& request) const;
     bool SignRequest(HttpRequest& request, const DateTime& now, const std::string& uuid) const;
 
+    PreparedRequest PrepareRequest(const HttpRequest& request) const;
+
+    bool SignRequest(HttpRequest& request, const PreparedRequest& prepared) const;
+    bool SignRequest(HttpRequest& request, const PreparedRequest& prepared, const DateTime& now,
+                     const std::string& uuid) const;
+
+    /**
+     * Signs count requests with one timestamp and derived key. Returns whether each request was signed.
+     */
+    std::vector<bool> SignRequests(HttpRequest* requests, size_t count) const;
+    std::vector<bool> SignRequests(HttpRequest* requests, size_t count, const DateTime& now,
+                                   const std::vector<std::string>& uuids) const;
+
+    /**
+     * Same as above, spread over threadCount threads (the calling one included) that steal work from each other.
+     */
+    std::vector<bool> SignRequests(HttpRequest* requests, size_t count, size_t threadCount) const;
+    std::vector<bool> SignRequests(HttpRequest* requests, size_t count, size_t threadCount, const DateTime& now,
+                                   const std::vector<std::string>& uuids) const;
+
 private:
+    /**
+     * What every request signed at the same instant shares, plus the hasher and scratch space reused between
+     * them. One context is only ever used by one thread at a time.
+     */
+    struct SigningContext
+    {
+        std::string dateHeaderValue;
+        std::string simpleDate;
+        std::string credentialScope;
+        std::string encodedPath;
+        std::string authorization;
+        Sha256HMACMidstate signingKey;
+        Sha256 hash;
+        CanonicalRequestBuilder builder;
+    };
+
+    bool SignRequest(HttpRequest& request, const PreparedRequest* prepared) const;
+    bool SignRequest(HttpRequest& request, const PreparedRequest* prepared, const DateTime& now,
+                     const std::string& uuid) const;
+    bool PrepareSigningContext(const DateTime& now, SigningContext& context) const;
+    bool SignRequest(HttpRequest& request, const std::string& uuid, SigningContext& context,
+                     const PreparedRequest* prepared = nullptr) const;
+    void BeginPreparedCanonicalRequest(HttpRequest& request, const PreparedRequest& prepared,
+                                       SigningContext& context) const;
+    void AppendCanonicalHeaders(const HeaderValueCollection& headers, const PreparedRequest* prepared,
+                                CanonicalRequestBuilder& builder) const;
     bool ShouldSignHeader(const std::string& header) const;
-    std::string GenerateSignature(const Credential& credentials, const std::string& stringToSign, const std::string& simpleDate) const;
-    std::string GenerateSignature(const std::string& stringToSign, const std::string& key) const;
-    std::string GenerateStringToSign(const std::string& dateValue, const std::string& simpleDate, const std::string& canonicalRequestHash,
-                                const std::string& region, const std::string& serviceName) const;
+    Sha256HMACMidstate GetSigningKey(const std::string& simpleDate) const;
+    Sha256HexDigest GenerateSignature(StringView stringToSign, const Sha256HMACMidstate& key) const;
 
-    std::string ComputeHash(const std::string& secretKey, const std::string& simpleDate, const std::string& region,
-                        const std::string& serviceName) const;
-    std::string ComputePayloadHash(HttpRequest& request) const;
-    DateTime GetSigningTimestamp() const { return DateTime::Now(); }
+    HashResult ComputeHash(const std::string& secretKey, const std::string& simpleDate, const std::string& region,
+                           const std::string& serviceName) const;
+    bool ComputePayloadHash(HttpRequest& request, Sha256& hash, StringView& payloadHash) const;
+    DateTime GetSigningTimestamp() const { return DateTime::Now(m_clockSource); }
 
     Credential m_credential;
     std::string m_serviceName;
     std::string m_region;
     std::set<std::string> m_unsignedHeaders;
-    std::unique_ptr<Sha256> m_hash;
     std::unique_ptr<Sha256HMAC> m_hmac;
+    std::string m_signingKeyId;
+    SigningKeyCache* m_signingKeyCache;
+    ClockSource m_clockSource;
 };
 
 }
@@ -0,0 +1,90 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include "jdcloud_signer/util/crypto/Sha256HMACMidstate.h"
+
+namespace jdcloud_signer {
+
+/**
+ * Caches derived signing keys (kDate -> kRegion -> kService -> jdcloud2_request) per signing key id and UTC day.
+ * Keys are kept as HMAC midstates, so a hit can sign without hashing the ipad/opad blocks again.
+ *
+ * The signing key id is a 32 byte digest identifying (secret, region, service), see MakeSigningKeyId. The cache is
+ * a fixed array of slots, so memory is bounded. Lookups never take a lock: each slot is guarded by a sequence
+ * counter and a reader that races with a writer simply misses. Inserting a newer day evicts every entry of the
+ * days before it.
+ */
+class SigningKeyCache
+{
+public:
+    static const size_t SLOT_COUNT = 64;
+    static const size_t ID_LENGTH = 32;
+
+    SigningKeyCache();
+
+    /**
+     * The process wide cache shared by all signers.
+     */
+    static SigningKeyCache& GetDefault();
+
+    /**
+     * Builds the id used to look up derived keys for a secret, region and service. The secret is not recoverable from it.
+     */
+    static std::string MakeSigningKeyId(const std::string& secretKey, const std::string& region, const std::string& serviceName);
+
+    /**
+     * Looks up the derived key of signingKeyId for simpleDate (%Y%m%d). Returns false on a miss.
+     */
+    bool Get(const std::string& signingKeyId, const std::string& simpleDate, Sha256HMACMidstate& derivedKey) const;
+
+    /**
+     * Stores the derived key of signingKeyId for simpleDate (%Y%m%d).
+     */
+    void Put(const std::string& signingKeyId, const std::string& simpleDate, const Sha256HMACMidstate& derivedKey);
+
+    /**
+     * Drops every entry.
+     */
+    void Clear();
+
+private:
+    static const size_t ID_WORDS = ID_LENGTH / sizeof(uint64_t);
+    static const size_t STATE_WORDS = SHA256_DIGEST_WORDS * sizeof(uint32_t) / sizeof(uint64_t);
+    static const size_t PROBE_LENGTH = 4;
+
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence;
+        std::atomic<uint32_t> day;
+        std::atomic<uint64_t> id[ID_WORDS];
+        std::atomic<uint64_t> inner[STATE_WORDS];
+        std::atomic<uint64_t> outer[STATE_WORDS];
+    };
+
+    static uint32_t ParseDay(const std::string& simpleDate);
+    size_t FirstSlot(const uint64_t* id) const;
+    void WriteSlot(Slot& slot, uint32_t day, const uint64_t* id, const uint64_t* inner, const uint64_t* outer);
+
+    Slot m_slots[SLOT_COUNT];
+    std::mutex m_writeMutex;
+    uint32_t m_latestDay;
+};
+
+}
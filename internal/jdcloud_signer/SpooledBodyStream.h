@@ -0,0 +1,116 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <stdint.h>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace jdcloud_signer {
+
+/**
+ * Reads a body that cannot seek, like a pipe, a socket or a decompressor, keeping a copy of what it read. Seeking
+ * back then reads the copy, so the body can be hashed for the signature and sent afterwards while the source is
+ * only read once. The copy stays in memory up to memoryLimit bytes and moves to a temporary file past that.
+ *
+ * Only positions already read can be sought. When the copy cannot be written or read back the stream ends early
+ * and HasFailed reports it.
+ */
+class SpooledBodyStreambuf : public std::streambuf
+{
+public:
+    static const size_t DEFAULT_MEMORY_LIMIT = 1024 * 1024;
+    static const size_t BUFFER_SIZE = 64 * 1024;
+
+    /**
+     * Opens the file the copy moves to, which the streambuf then owns and closes. Returns nullptr on failure.
+     */
+    typedef std::function<FILE*()> FileOpener;
+
+    explicit SpooledBodyStreambuf(const std::shared_ptr<std::iostream>& source,
+                                  size_t memoryLimit = DEFAULT_MEMORY_LIMIT,
+                                  const FileOpener& openFile = std::tmpfile);
+    ~SpooledBodyStreambuf();
+
+    SpooledBodyStreambuf(const SpooledBodyStreambuf&) = delete;
+    SpooledBodyStreambuf& operator=(const SpooledBodyStreambuf&) = delete;
+
+    inline const std::shared_ptr<std::iostream>& GetSource() const { return m_source; }
+
+    /**
+     * Whether the copy went to a temporary file.
+     */
+    inline bool IsSpooledToFile() const { return m_file != nullptr; }
+
+    /**
+     * Whether the source, or the copy of it, could not be read or written, which makes what was read incomplete.
+     */
+    inline bool HasFailed() const { return m_failed; }
+
+protected:
+    int_type underflow() override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which = std::ios_base::in | std::ios_base::out) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in | std::ios_base::out) override;
+
+private:
+    bool ReadSpool();
+    bool ReadSource();
+    void Spool(const char* data, size_t length);
+
+    std::shared_ptr<std::iostream> m_source;
+    size_t m_memoryLimit;
+    FileOpener m_openFile;
+    std::string m_memory;
+    FILE* m_file;
+    std::vector<char> m_buffer;
+    uint64_t m_spooled;
+    uint64_t m_position;
+    bool m_sourceDone;
+    bool m_failed;
+};
+
+/**
+ * A stream over a SpooledBodyStreambuf, what the signer puts in place of a body that cannot seek.
+ */
+class SpooledBodyStream : public std::iostream
+{
+public:
+    explicit SpooledBodyStream(const std::shared_ptr<std::iostream>& source,
+                               size_t memoryLimit = SpooledBodyStreambuf::DEFAULT_MEMORY_LIMIT,
+                               const SpooledBodyStreambuf::FileOpener& openFile = std::tmpfile);
+
+    inline const std::shared_ptr<std::iostream>& GetSource() const { return m_buffer.GetSource(); }
+
+    inline bool IsSpooledToFile() const { return m_buffer.IsSpooledToFile(); }
+
+    inline bool HasFailed() const { return m_buffer.HasFailed(); }
+
+    /**
+     * Whether stream can seek back, which is what hashing a body before sending it needs.
+     */
+    static bool IsSeekable(std::iostream& stream);
+
+private:
+    SpooledBodyStreambuf m_buffer;
+};
+
+}
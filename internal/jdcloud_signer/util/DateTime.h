@@ -18,6 +18,7 @@
 
 #include <chrono>
 #include <string>
+#include "jdcloud_signer/ClockSource.h"
 
 namespace jdcloud_signer {
 
@@ -55,6 +56,18 @@ enum class DayOfWeek
     Saturday
 };
 
+/**
+ * The two GMT dates a request is signed with, "%Y%m%dT%H%M%SZ" and "%Y%m%d", NUL terminated.
+ */
+struct SigningDates
+{
+    static const size_t LONG_DATE_LENGTH = 16;
+    static const size_t SHORT_DATE_LENGTH = 8;
+
+    char longDate[LONG_DATE_LENGTH + 1];
+    char shortDate[SHORT_DATE_LENGTH + 1];
+};
+
 /**
  * Wrapper for all the weird crap we need to do with timestamps.
  */
@@ -126,6 +139,12 @@ public:
      */
     std::string ToGmtString(const char* formatStr) const;
 
+    /**
+     * Formats the signing dates of this datetime in one pass, without gmtime, strftime or the locale. The last
+     * second formatted is cached process wide, so signers working in the same second share the result.
+     */
+    void ToSigningDates(SigningDates& dates) const;
+
     /**
      * Get the representation of this datetime as seconds.milliseconds since epoch
      */
@@ -151,6 +170,11 @@ public:
      */
     static DateTime Now();
 
+    /**
+     * This very instant as seen by source, see ClockSource.
+     */
+    static DateTime Now(ClockSource source);
+
     /**
      * Compute the difference between two timestamps.
      */
@@ -19,17 +19,69 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include "jdcloud_signer/StringView.h"
 
 namespace jdcloud_signer {
 
+/**
+ * The characters URL encoding copies as they are, everything else is percent encoded.
+ */
+enum class URLSafeCharacters
+{
+    /**
+     * RFC 3986 unreserved characters: letters, digits and -_.~
+     */
+    Unreserved,
+
+    /**
+     * Unreserved plus the reserved characters URI::URLEncodePathRFC3986 keeps in a path: $&,/:;=@
+     */
+    Path
+};
+
 /**
  * All the things the c++ stdlib is missing for string operations that I needed.
+ *
+ * The functions taking StringView do not allocate: they return views into their argument, which must outlive the
+ * result, or work in place. They only know ASCII, which is all that HTTP names and the C locale functions the
+ * other ones use care about.
  */
 class StringUtils
 {
 public:
     static void Replace(std::string& s, const char* search, const char* replace);
 
+    /**
+     * Whether c is a space as isspace sees it in the C locale: space, \t, \n, \v, \f or \r.
+     */
+    static inline bool IsSpace(char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+    static inline char ToLower(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c; }
+
+    /**
+     * Converts source to lower case in place.
+     */
+    static void ToLowerInPlace(std::string& source);
+
+    /**
+     * Compares two strings ignoring case.
+     */
+    static bool CaselessEquals(StringView value1, StringView value2);
+
+    /**
+     * source without the spaces at its start, its end or both.
+     */
+    static StringView LTrimView(StringView source);
+    static StringView RTrimView(StringView source);
+    static StringView TrimView(StringView source);
+
+    /**
+     * Splits toSplit on splitOn into parts, replacing its contents. Empty items are excluded, as with Split.
+     */
+    static void SplitView(StringView toSplit, char splitOn, std::vector<StringView>& parts);
+
+    static std::vector<StringView> SplitView(StringView toSplit, char splitOn);
+
     /**
      * Converts a string to lower case.
      */
@@ -53,6 +105,13 @@ public:
      */
     static std::string URLEncode(const char* unsafe);
 
+    /**
+     * Appends the URL encoding of unsafe to encoded (upper case hex, %20 for spaces). Runs of safe characters are
+     * found with SSE2 or AVX2 where available and copied in one go.
+     */
+    static void URLEncode(StringView unsafe, std::string& encoded,
+                          URLSafeCharacters safe = URLSafeCharacters::Unreserved);
+
     /**
      * Http Clients tend to escape some characters but not all. Escaping all of them causes problems, because the client
      * will also try to escape them.
@@ -0,0 +1,36 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace jdcloud_signer {
+
+/**
+ * Runs task(worker, index) for every index in [0, count) on workerCount threads, the calling thread being worker 0.
+ *
+ * Each worker starts with an equal contiguous share of the indexes and takes them from the front. A worker that runs
+ * out steals the back half of the largest remaining share, so a few expensive items do not hold up the others.
+ */
+class WorkStealingScheduler
+{
+public:
+    typedef std::function<void(size_t worker, size_t index)> Task;
+
+    static void Run(size_t count, size_t workerCount, const Task& task);
+};
+
+}
@@ -18,9 +18,10 @@
 
 #include <string>
 #include "Outcome.h"
+#include "Sha256Digest.h"
 
 namespace jdcloud_signer {
 
-using HashResult = Outcome<std::string, bool>;
+using HashResult = Outcome<Sha256Digest, bool>;
 
 }
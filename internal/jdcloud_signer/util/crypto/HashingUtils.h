@@ -20,10 +20,41 @@
 
 namespace jdcloud_signer {
 
+/**
+ * Hex encoding kernels. The SIMD ones are only used when the CPU running the code supports them.
+ */
+enum class HexKernel
+{
+    Scalar,
+    SSSE3,
+    AVX2
+};
+
 class HashingUtils
 {
 public:
     static std::string HexEncode(const unsigned char* message, size_t length);
+
+    /**
+     * Writes the lower case hex of message to hex, which must have room for 2 * length characters. Uses the best
+     * kernel for this CPU.
+     */
+    static void HexEncode(const unsigned char* message, size_t length, char* hex);
+
+    static void HexEncode(const unsigned char* message, size_t length, char* hex, HexKernel kernel);
+
+    /**
+     * Decodes length hex characters (either case) into length / 2 bytes at message. Returns false if length is odd
+     * or a character is not a hex digit, message is then partially written.
+     */
+    static bool HexDecode(const char* hex, size_t length, unsigned char* message);
+
+    static bool IsHexKernelSupported(HexKernel kernel);
+
+    /**
+     * The kernel HexEncode picks, decided once per process.
+     */
+    static HexKernel GetHexKernel();
 };
 
 }
@@ -0,0 +1,43 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+
+namespace jdcloud_signer {
+
+/**
+ * Hands out request nonces from a per-thread buffer of random bytes, refilled from the OS CSPRNG (getrandom on
+ * Linux, OpenSSL's RAND_bytes elsewhere) a few KB at a time. Every thread has its own buffer so no lock is taken.
+ * A forked child drops the buffers it inherited, so parent and child never hand out the same nonce.
+ */
+class NonceGenerator
+{
+public:
+    static const size_t NONCE_LENGTH = 16;
+    static const size_t BUFFER_LENGTH = 4096;
+
+    /**
+     * Writes count nonces of NONCE_LENGTH random bytes each to nonces. Returns false if the CSPRNG failed.
+     */
+    static bool Generate(unsigned char* nonces, size_t count = 1);
+
+    /**
+     * One nonce, hex encoded as sent in the nonce header. Empty if the CSPRNG failed.
+     */
+    static std::string GenerateHex();
+};
+
+}
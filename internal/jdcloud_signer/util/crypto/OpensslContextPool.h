@@ -0,0 +1,40 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+namespace jdcloud_signer {
+
+/**
+ * OpenSSL contexts kept per thread and reused between digests, instead of a create/free per Calculate call. A
+ * context is handed out by reference to the calling thread only, so users must not hold on to it across calls
+ * that may hash too. Everything is released when the thread exits.
+ */
+class OpensslContextPool
+{
+public:
+    /**
+     * The SHA256 EVP_MD, fetched once from the default provider on OpenSSL 3 so digests skip the implicit lookup.
+     */
+    static const EVP_MD* GetSha256();
+
+    static EVP_MD_CTX* GetDigestContext();
+
+    static HMAC_CTX* GetHMACContext();
+};
+
+}
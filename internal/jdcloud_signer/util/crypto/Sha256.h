@@ -22,6 +22,8 @@
 #include <memory.h>
 #include "HashResult.h"
 
+struct evp_md_ctx_st;
+
 namespace jdcloud_signer {
 
 class Sha256
@@ -30,18 +32,44 @@ public:
     /**
      * Initializes platform crypto libs.
      */
-    Sha256() {};
-    virtual ~Sha256() {};
+    Sha256();
+    virtual ~Sha256();
+
+    /**
+     * Copies only make a fresh hasher, an incremental digest in progress is not copied.
+     */
+    Sha256(const Sha256&);
+    Sha256& operator=(const Sha256&);
 
     /**
      * Calculates a SHA256 Hash digest (not hex encoded)
      */
     HashResult Calculate(const std::string& str);
 
+    /**
+     * Calculates a SHA256 Hash digest of length bytes at data
+     */
+    HashResult Calculate(const char* data, size_t length);
+
     /**
      * Calculates a Hash digest on a stream (the entire stream is read)
      */
     HashResult Calculate(std::istream& stream);
+
+    /**
+     * Starts an incremental digest, fed by Update and completed by Finish.
+     */
+    void Begin();
+
+    void Update(const char* data, size_t length);
+
+    /**
+     * Completes the incremental digest.
+     */
+    HashResult Finish();
+
+private:
+    evp_md_ctx_st* m_ctx;
 };
 
 }
@@ -0,0 +1,65 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace jdcloud_signer {
+
+static const size_t SHA256_BLOCK_LENGTH = 64;
+static const size_t SHA256_DIGEST_WORDS = 8;
+
+/**
+ * Portable SHA256 (FIPS 180-4) whose chaining state can be read and restored. It is used where the OpenSSL
+ * context can not be resumed from a precomputed state.
+ */
+class Sha256Builtin
+{
+public:
+    Sha256Builtin();
+
+    /**
+     * Starts a new digest from the standard initial state.
+     */
+    void Init();
+
+    /**
+     * Resumes a digest from a chaining state taken after bytesHashed bytes (a multiple of the block length).
+     */
+    void Init(const uint32_t* state, uint64_t bytesHashed);
+
+    void Update(const unsigned char* data, size_t length);
+
+    /**
+     * Writes the 32 byte digest.
+     */
+    void Final(unsigned char* digest);
+
+    /**
+     * Copies the chaining state, only meaningful on a block boundary.
+     */
+    void GetState(uint32_t* state) const;
+
+private:
+    void Compress(const unsigned char* block);
+
+    uint32_t m_state[SHA256_DIGEST_WORDS];
+    uint64_t m_bytesHashed;
+    unsigned char m_buffer[SHA256_BLOCK_LENGTH];
+    size_t m_bufferLength;
+};
+
+}
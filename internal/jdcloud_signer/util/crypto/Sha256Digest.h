@@ -0,0 +1,79 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstring>
+#include <string>
+#include "jdcloud_signer/StringView.h"
+
+namespace jdcloud_signer {
+
+/**
+ * A raw SHA256 digest held by value, so hashing results and derived keys move around without heap allocations.
+ */
+class Sha256Digest
+{
+public:
+    static const size_t LENGTH = 32;
+
+    Sha256Digest() { std::memset(m_bytes, 0, LENGTH); }
+    explicit Sha256Digest(const unsigned char* bytes) { std::memcpy(m_bytes, bytes, LENGTH); }
+
+    inline unsigned char* data() { return m_bytes; }
+    inline const unsigned char* data() const { return m_bytes; }
+    inline size_t size() const { return LENGTH; }
+
+    /**
+     * The raw bytes as a string.
+     */
+    inline std::string ToString() const { return std::string((const char*)m_bytes, LENGTH); }
+
+    /**
+     * Lower case hex, see Sha256HexDigest to avoid the string.
+     */
+    std::string ToHexString() const;
+
+private:
+    unsigned char m_bytes[LENGTH];
+};
+
+inline bool operator==(const Sha256Digest& a, const Sha256Digest& b)
+{
+    return std::memcmp(a.data(), b.data(), Sha256Digest::LENGTH) == 0;
+}
+
+inline bool operator!=(const Sha256Digest& a, const Sha256Digest& b) { return !(a == b); }
+
+/**
+ * The lower case hex text of a Sha256Digest, for the places where the protocol wants text.
+ */
+class Sha256HexDigest
+{
+public:
+    static const size_t LENGTH = Sha256Digest::LENGTH * 2;
+
+    Sha256HexDigest() { std::memset(m_hex, '0', LENGTH); }
+    explicit Sha256HexDigest(const Sha256Digest& digest);
+
+    inline const char* data() const { return m_hex; }
+    inline size_t size() const { return LENGTH; }
+    inline operator StringView() const { return StringView(m_hex, LENGTH); }
+    inline std::string ToString() const { return std::string(m_hex, LENGTH); }
+
+private:
+    char m_hex[LENGTH];
+};
+
+}
@@ -36,6 +36,13 @@ public:
      * Calculates a SHA256 HMAC digest (not hex encoded)
      */
     HashResult Calculate(const std::string& toSign, const std::string& secret);
+
+    /**
+     * Same as above keyed by a digest, e.g. to chain derived keys.
+     */
+    HashResult Calculate(const std::string& toSign, const Sha256Digest& key);
+
+    HashResult Calculate(const char* data, size_t length, const unsigned char* key, size_t keyLength);
 };
 
 }
@@ -0,0 +1,71 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include "HashResult.h"
+#include "Sha256Builtin.h"
+
+namespace jdcloud_signer {
+
+enum class Sha256Implementation
+{
+    OpenSSL,
+    Builtin
+};
+
+/**
+ * HMAC-SHA256 for a fixed key, with the SHA256 states after the ipad and opad blocks computed once. Calculate
+ * then only compresses the message and the inner digest. Plain value type, cheap to copy and safe to share
+ * between threads.
+ */
+class Sha256HMACMidstate
+{
+public:
+    Sha256HMACMidstate();
+
+    explicit Sha256HMACMidstate(const std::string& secret);
+
+    explicit Sha256HMACMidstate(const Sha256Digest& key);
+
+    /**
+     * Rebuilds a midstate from the words returned by GetInnerState/GetOuterState.
+     */
+    Sha256HMACMidstate(const uint32_t* innerState, const uint32_t* outerState);
+
+    inline bool IsValid() const { return m_valid; }
+
+    inline const uint32_t* GetInnerState() const { return m_inner; }
+
+    inline const uint32_t* GetOuterState() const { return m_outer; }
+
+    /**
+     * Calculates a SHA256 HMAC digest. Both implementations give identical results, OpenSSL
+     * falls back to the builtin one when its low level SHA256 API is not available.
+     */
+    HashResult Calculate(const std::string& toSign, Sha256Implementation implementation = Sha256Implementation::OpenSSL) const;
+
+    HashResult Calculate(const char* data, size_t length, Sha256Implementation implementation = Sha256Implementation::OpenSSL) const;
+
+private:
+    void Init(const unsigned char* secret, size_t length);
+
+    uint32_t m_inner[SHA256_DIGEST_WORDS];
+    uint32_t m_outer[SHA256_DIGEST_WORDS];
+    bool m_valid;
+};
+
+}
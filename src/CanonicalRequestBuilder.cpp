@@ -0,0 +1,195 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "jdcloud_signer/CanonicalRequestBuilder.h"
+
+using namespace std;
+
+namespace jdcloud_signer {
+
+const size_t CanonicalRequestBuilder::INITIAL_CAPACITY;
+const size_t CanonicalRequestBuilder::STAGING_CAPACITY;
+
+static const char NEWLINE = '\n';
+
+CanonicalRequestBuilder::CanonicalRequestBuilder() :
+    m_digest(nullptr),
+    m_streaming(false),
+    m_canonicalRequestBegin(0),
+    m_signedHeadersBegin(0),
+    m_signedHeadersEnd(0),
+    m_canonicalRequestEnd(0),
+    m_stringToSignBegin(0),
+    m_stringToSignEnd(0),
+    m_authorizationBegin(0)
+{
+    m_buffer.reserve(INITIAL_CAPACITY);
+    m_headerNames.reserve(16);
+}
+
+void CanonicalRequestBuilder::BeginCanonicalRequest(StringView method, StringView encodedPath, StringView queryString,
+                                                    Sha256* digest, bool keepCanonicalRequest)
+{
+    m_buffer.clear();
+    m_staging.clear();
+    m_headerNames.clear();
+    m_digest = digest;
+    m_streaming = digest != nullptr && !keepCanonicalRequest;
+    m_canonicalRequestBegin = 0;
+    m_signedHeadersBegin = m_signedHeadersEnd = 0;
+    m_canonicalRequestEnd = 0;
+    m_stringToSignBegin = m_stringToSignEnd = 0;
+    m_authorizationBegin = 0;
+
+    if (m_digest)
+    {
+        m_digest->Begin();
+    }
+    if (m_streaming && m_staging.capacity() < STAGING_CAPACITY)
+    {
+        m_staging.reserve(STAGING_CAPACITY);
+    }
+
+    Write(method);
+    Write(NEWLINE);
+    Write(encodedPath);
+    Write(NEWLINE);
+
+    if (queryString.size() > 1)
+    {
+        Write(queryString.substr(1));
+        // a lone key with no '=' anywhere is signed as "key=".
+        if (queryString.find('=') == StringView::npos)
+        {
+            Write('=');
+        }
+    }
+    Write(NEWLINE);
+}
+
+void CanonicalRequestBuilder::AppendHeader(StringView name, StringView value)
+{
+    if (m_streaming)
+    {
+        // the header lines are gone once hashed, so the signed headers list is collected on the side.
+        if (m_buffer.size() > 0)
+        {
+            Append(';');
+        }
+        Append(name);
+    }
+    else
+    {
+        m_headerNames.emplace_back(m_buffer.size(), name.size());
+    }
+
+    Write(name);
+    Write(':');
+    Write(value);
+    Write(NEWLINE);
+}
+
+void CanonicalRequestBuilder::EndCanonicalRequest(StringView payloadHash)
+{
+    Write(NEWLINE);
+
+    if (m_streaming)
+    {
+        m_signedHeadersBegin = 0;
+        m_signedHeadersEnd = m_buffer.size();
+        Write(GetSignedHeaders());
+        Write(NEWLINE);
+        Write(payloadHash);
+        Flush();
+
+        // nothing of the canonical request is kept, the buffer only holds the signed headers.
+        m_canonicalRequestBegin = m_canonicalRequestEnd = m_buffer.size();
+        return;
+    }
+
+    // the names are copied from earlier in the same buffer, make room first so it can not move under us.
+    size_t signedHeadersLength = 0;
+    for (const auto& name : m_headerNames)
+    {
+        signedHeadersLength += name.second + 1;
+    }
+    m_buffer.reserve(m_buffer.size() + signedHeadersLength + 1 + payloadHash.size());
+
+    m_signedHeadersBegin = m_buffer.size();
+    for (size_t i = 0; i < m_headerNames.size(); ++i)
+    {
+        if (i > 0)
+        {
+            Append(';');
+        }
+        m_buffer.append(m_buffer.data() + m_headerNames[i].first, m_headerNames[i].second);
+    }
+    m_signedHeadersEnd = m_buffer.size();
+
+    Append(NEWLINE);
+    Append(payloadHash);
+    m_canonicalRequestEnd = m_buffer.size();
+
+    if (m_digest)
+    {
+        m_digest->Update(m_buffer.data(), m_canonicalRequestEnd);
+    }
+}
+
+void CanonicalRequestBuilder::BuildStringToSign(StringView algorithm, StringView dateValue, StringView credentialScope,
+                                                StringView canonicalRequestHash)
+{
+    m_buffer.resize(m_canonicalRequestEnd);
+    m_stringToSignBegin = m_buffer.size();
+
+    Append(algorithm);
+    Append(NEWLINE);
+    Append(dateValue);
+    Append(NEWLINE);
+    Append(credentialScope);
+    Append(NEWLINE);
+    Append(canonicalRequestHash);
+
+    m_stringToSignEnd = m_buffer.size();
+}
+
+void CanonicalRequestBuilder::BuildAuthorization(StringView algorithm, StringView accessKey, StringView credentialScope,
+                                                 StringView signature)
+{
+    m_buffer.resize(m_stringToSignEnd);
+    m_buffer.reserve(m_buffer.size() + algorithm.size() + accessKey.size() + credentialScope.size()
+                     + (m_signedHeadersEnd - m_signedHeadersBegin) + signature.size() + 64);
+    m_authorizationBegin = m_buffer.size();
+
+    Append(algorithm);
+    Append(" Credential=");
+    Append(accessKey);
+    Append('/');
+    Append(credentialScope);
+    Append(", SignedHeaders=");
+    m_buffer.append(m_buffer.data() + m_signedHeadersBegin, m_signedHeadersEnd - m_signedHeadersBegin);
+    Append(", Signature=");
+    Append(signature);
+}
+
+void CanonicalRequestBuilder::Flush()
+{
+    if (!m_staging.empty())
+    {
+        m_digest->Update(m_staging.data(), m_staging.size());
+        m_staging.clear();
+    }
+}
+
+}
@@ -0,0 +1,182 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "jdcloud_signer/ChunkedSigningStream.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include "jdcloud_signer/logging/LogMacros.h"
+
+using namespace std;
+
+namespace jdcloud_signer {
+
+const size_t ChunkedSigningStreambuf::DEFAULT_CHUNK_SIZE;
+
+static const char* CHUNK_ALGORITHM = "JDCLOUD2-HMAC-SHA256-PAYLOAD";
+static const char* CHUNK_SIGNATURE = ";chunk-signature=";
+static const char* CRLF = "\r\n";
+static const char* EMPTY_STRING_SHA256_HEX = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+static const char* logTag = "ChunkedSigningStream";
+
+static size_t HexLength(uint64_t value)
+{
+    size_t length = 1;
+    while (value >>= 4)
+    {
+        ++length;
+    }
+    return length;
+}
+
+static uint64_t GetEncodedChunkLength(uint64_t payloadLength)
+{
+    return HexLength(payloadLength) + strlen(CHUNK_SIGNATURE) + Sha256HexDigest::LENGTH + 2 + payloadLength + 2;
+}
+
+ChunkedSigningStreambuf::ChunkedSigningStreambuf(const shared_ptr<iostream>& source, StringView dateHeaderValue,
+                                                 StringView credentialScope, const Sha256HMACMidstate& signingKey,
+                                                 const Sha256HexDigest& seedSignature, size_t chunkSize) :
+    m_source(source),
+    m_dateHeaderValue(dateHeaderValue.ToString()),
+    m_credentialScope(credentialScope.ToString()),
+    m_signingKey(signingKey),
+    m_seedSignature(seedSignature),
+    m_previousSignature(seedSignature),
+    m_chunkSize(chunkSize > 0 ? chunkSize : DEFAULT_CHUNK_SIZE),
+    m_payload(m_chunkSize),
+    m_encodedBefore(0),
+    m_finished(false)
+{
+    m_encoded.reserve(GetEncodedChunkLength(m_chunkSize));
+}
+
+uint64_t ChunkedSigningStreambuf::GetEncodedLength(uint64_t payloadLength, size_t chunkSize)
+{
+    if (chunkSize == 0)
+    {
+        chunkSize = DEFAULT_CHUNK_SIZE;
+    }
+    uint64_t remainder = payloadLength % chunkSize;
+    return payloadLength / chunkSize * GetEncodedChunkLength(chunkSize)
+           + (remainder > 0 ? GetEncodedChunkLength(remainder) : 0) + GetEncodedChunkLength(0);
+}
+
+bool ChunkedSigningStreambuf::NextChunk()
+{
+    if (m_finished)
+    {
+        return false;
+    }
+
+    m_source->read(m_payload.data(), m_chunkSize);
+    size_t length = static_cast<size_t>(m_source->gcount());
+    if (m_source->bad())
+    {
+        LOGSTREAM_ERROR(logTag, "Unable to read the request body");
+        return false;
+    }
+
+    auto payloadHash = m_hash.Calculate(m_payload.data(), length);
+    if (!payloadHash.IsSuccess())
+    {
+        LOGSTREAM_ERROR(logTag, "Unable to hash (sha256) a chunk of the request body");
+        return false;
+    }
+
+    m_stringToSign.assign(CHUNK_ALGORITHM).append("\n").append(m_dateHeaderValue).append("\n")
+        .append(m_credentialScope).append("\n").append(m_previousSignature.data(), Sha256HexDigest::LENGTH)
+        .append("\n").append(EMPTY_STRING_SHA256_HEX).append("\n")
+        .append(Sha256HexDigest(payloadHash.GetResult()).data(), Sha256HexDigest::LENGTH);
+    auto signature = m_signingKey.Calculate(m_stringToSign);
+    if (!signature.IsSuccess())
+    {
+        LOGSTREAM_ERROR(logTag, "Unable to hmac (sha256) a chunk of the request body");
+        return false;
+    }
+    m_previousSignature = Sha256HexDigest(signature.GetResult());
+
+    char size[17];
+    snprintf(size, sizeof(size), "%zx", length);
+    m_encodedBefore += egptr() - eback();
+    m_encoded.assign(size).append(CHUNK_SIGNATURE).append(m_previousSignature.data(), Sha256HexDigest::LENGTH)
+        .append(CRLF).append(m_payload.data(), length).append(CRLF);
+    setg(&m_encoded[0], &m_encoded[0], &m_encoded[0] + m_encoded.size());
+
+    //the empty chunk ends the body.
+    m_finished = length == 0;
+    return true;
+}
+
+ChunkedSigningStreambuf::int_type ChunkedSigningStreambuf::underflow()
+{
+    if (gptr() == egptr() && !NextChunk())
+    {
+        return traits_type::eof();
+    }
+    return traits_type::to_int_type(*gptr());
+}
+
+bool ChunkedSigningStreambuf::Rewind()
+{
+    m_source->clear();
+    m_source->seekg(0);
+    if (m_source->fail())
+    {
+        LOGSTREAM_ERROR(logTag, "Unable to seek the request body back to its start");
+        return false;
+    }
+
+    m_previousSignature = m_seedSignature;
+    m_encodedBefore = 0;
+    m_finished = false;
+    setg(nullptr, nullptr, nullptr);
+    return true;
+}
+
+ChunkedSigningStreambuf::pos_type ChunkedSigningStreambuf::seekoff(off_type off, ios_base::seekdir dir,
+                                                                   ios_base::openmode which)
+{
+    if (!(which & ios_base::in) || off != 0)
+    {
+        return pos_type(off_type(-1));
+    }
+    if (dir == ios_base::cur)
+    {
+        return pos_type(off_type(m_encodedBefore + (gptr() - eback())));
+    }
+    if (dir == ios_base::beg && Rewind())
+    {
+        return pos_type(0);
+    }
+    return pos_type(off_type(-1));
+}
+
+ChunkedSigningStreambuf::pos_type ChunkedSigningStreambuf::seekpos(pos_type pos, ios_base::openmode which)
+{
+    return seekoff(off_type(pos), ios_base::beg, which);
+}
+
+ChunkedSigningStream::ChunkedSigningStream(const shared_ptr<iostream>& source, StringView dateHeaderValue,
+                                           StringView credentialScope, const Sha256HMACMidstate& signingKey,
+                                           const Sha256HexDigest& seedSignature, size_t chunkSize) :
+    iostream(nullptr),
+    m_buffer(source, dateHeaderValue, credentialScope, signingKey, seedSignature, chunkSize)
+{
+    rdbuf(&m_buffer);
+}
+
+}
@@ -16,6 +16,7 @@
 
 #include "jdcloud_signer/JdcloudSigner.h"
 
+#include "jdcloud_signer/ChunkedSigningStream.h"
 #include "jdcloud_signer/JdcloudSignerImpl.h"
 
 using namespace std;
@@ -23,9 +24,13 @@ using namespace std;
 namespace jdcloud_signer {
 
 JdcloudSigner::JdcloudSigner(const Credential& credential, const string& serviceName, const string& region) :
-    m_credential(credential),
-    m_serviceName(serviceName),
-    m_region(region)
+    m_impl(make_shared<JdcloudSignerImpl>(credential, serviceName, region))
+{
+}
+
+JdcloudSigner::JdcloudSigner(const Credential& credential, const string& serviceName, const string& region,
+                             ClockSource clockSource) :
+    m_impl(make_shared<JdcloudSignerImpl>(credential, serviceName, region, clockSource))
 {
 }
 
@@ -35,8 +40,42 @@ JdcloudSigner::~JdcloudSigner()
 
 bool JdcloudSigner::SignRequest(HttpRequest& request) const
 {
-    JdcloudSignerImpl impl(m_credential, m_serviceName, m_region);
-    return impl.SignRequest(request);
+    return m_impl->SignRequest(request);
+}
+
+PreparedRequest JdcloudSigner::PrepareRequest(const HttpRequest& request) const
+{
+    return m_impl->PrepareRequest(request);
+}
+
+bool JdcloudSigner::SignRequest(HttpRequest& request, const PreparedRequest& prepared) const
+{
+    return m_impl->SignRequest(request, prepared);
+}
+
+vector<bool> JdcloudSigner::SignRequests(HttpRequest* requests, size_t count) const
+{
+    return m_impl->SignRequests(requests, count);
+}
+
+vector<bool> JdcloudSigner::SignRequests(vector<HttpRequest>& requests) const
+{
+    return m_impl->SignRequests(requests.data(), requests.size());
+}
+
+vector<bool> JdcloudSigner::SignRequests(HttpRequest* requests, size_t count, size_t threadCount) const
+{
+    return m_impl->SignRequests(requests, count, threadCount);
+}
+
+vector<bool> JdcloudSigner::SignRequests(vector<HttpRequest>& requests, size_t threadCount) const
+{
+    return m_impl->SignRequests(requests.data(), requests.size(), threadCount);
+}
+
+uint64_t JdcloudSigner::GetStreamingContentLength(uint64_t payloadLength)
+{
+    return ChunkedSigningStreambuf::GetEncodedLength(payloadLength);
 }
 
 }
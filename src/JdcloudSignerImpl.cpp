@@ -16,13 +16,16 @@
 
 #include "jdcloud_signer/JdcloudSignerImpl.h"
 
-#ifdef WIN32
-#include <objbase.h>
-#else
-#include <uuid/uuid.h>
-#endif
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include "jdcloud_signer/ChunkedSigningStream.h"
+#include "jdcloud_signer/SpooledBodyStream.h"
 #include "jdcloud_signer/util/crypto/HashingUtils.h"
+#include "jdcloud_signer/util/crypto/NonceGenerator.h"
 #include "jdcloud_signer/util/StringUtils.h"
+#include "jdcloud_signer/util/WorkStealingScheduler.h"
 #include "jdcloud_signer/http/HttpTypes.h"
 #include "jdcloud_signer/logging/LogMacros.h"
 
@@ -30,27 +33,28 @@ using namespace std;
 
 namespace jdcloud_signer {
 
-static const char* EQ = "=";
-static const char* SIGNATURE = "Signature";
 static const char* HMAC_SHA256 = "JDCLOUD2-HMAC-SHA256";
 static const char* JDCLOUD_REQUEST = "jdcloud2_request";
-static const char* SIGNED_HEADERS = "SignedHeaders";
-static const char* CREDENTIAL = "Credential";
-static const char* NEWLINE = "\n";
 static const char* UNSIGNED_PAYLOAD = "UNSIGNED-PAYLOAD";
+static const char* STREAMING_PAYLOAD = "STREAMING-JDCLOUD2-HMAC-SHA256-PAYLOAD";
+static const char* CHUNKED_CONTENT_ENCODING = "jdcloud-chunked";
 static const char* SIGNING_KEY = "JDCLOUD2";
-static const char* LONG_DATE_FORMAT_STR = "%Y%m%dT%H%M%SZ";
-static const char* SIMPLE_DATE_FORMAT_STR = "%Y%m%d";
-static const char* EMPTY_STRING_SHA256 = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+static const unsigned char EMPTY_STRING_SHA256[Sha256Digest::LENGTH] = {
+    0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+    0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55
+};
 static const char* logTag = "JdcloudAuthSigner";
 
-JdcloudSignerImpl::JdcloudSignerImpl(const Credential& credential, const string& serviceName, const string& region) :
+JdcloudSignerImpl::JdcloudSignerImpl(const Credential& credential, const string& serviceName, const string& region,
+                                     ClockSource clockSource) :
     m_credential(credential),
     m_serviceName(serviceName),
     m_region(region),
     m_unsignedHeaders({USER_AGENT_HEADER, AUTHORIZATION_HEADER}),
-    m_hash(unique_ptr<Sha256>(new Sha256)),
-    m_hmac(unique_ptr<Sha256HMAC>(new Sha256HMAC))
+    m_hmac(unique_ptr<Sha256HMAC>(new Sha256HMAC)),
+    m_signingKeyId(SigningKeyCache::MakeSigningKeyId(credential.GetSecretKey(), region, serviceName)),
+    m_signingKeyCache(&SigningKeyCache::GetDefault()),
+    m_clockSource(clockSource)
 {
 }
 
@@ -58,117 +62,224 @@ JdcloudSignerImpl::~JdcloudSignerImpl()
 {
 }
 
-static HeaderValueCollection CanonicalizeHeaders(HeaderValueCollection&& headers)
+static bool IsTrimmedHeaderName(const string& name)
 {
-    HeaderValueCollection canonicalHeaders;
+    return name.empty() || (!StringUtils::IsSpace(name.front()) && !StringUtils::IsSpace(name.back()));
+}
+
+static map<string, string> CanonicalizeHeaders(const HeaderValueCollection& headers)
+{
+    map<string, string> canonicalHeaders;
     for (const auto& header : headers)
     {
-        auto trimmedHeaderName = StringUtils::Trim(header.first.c_str());
-        auto trimmedHeaderValue = StringUtils::Trim(header.second.c_str());
-
-        //multiline gets converted to line1,line2,etc...
-        auto headerMultiLine = StringUtils::SplitOnLine(trimmedHeaderValue);
-        string headerValue = headerMultiLine.size() == 0 ? "" : headerMultiLine[0];
-
-        if (headerMultiLine.size() > 1)
-        {
-            for(size_t i = 1; i < headerMultiLine.size(); ++i)
-            {
-                headerValue += ",";
-                headerValue += StringUtils::Trim(headerMultiLine[i].c_str());
-            }
-        }
-
-        //duplicate spaces need to be converted to one.
-        string::iterator new_end =
-                std::unique(headerValue.begin(), headerValue.end(),
-                            [=](char lhs, char rhs) { return (lhs == rhs) && (lhs == ' '); }
-                );
-        headerValue.erase(new_end, headerValue.end());
-
-        canonicalHeaders[trimmedHeaderName] = headerValue;
+        canonicalHeaders[StringUtils::TrimView(header.first.c_str()).ToString()] = header.GetCanonicalValue();
     }
 
     return canonicalHeaders;
 }
 
-static string CanonicalizeRequestSigningString(HttpRequest& request, bool urlEscapePath)
+static void BeginCanonicalRequest(HttpRequest& request, bool urlEscapePath, CanonicalRequestBuilder& builder,
+                                  Sha256& digest, bool keepCanonicalRequest, string& encodedPath)
 {
     request.CanonicalizeRequest();
-    stringstream signingStringStream;
-    signingStringStream << HttpMethodMapper::GetNameForHttpMethod(request.GetMethod());
 
-    URI uriCpy = request.GetUri();
     // Many services do not decode the URL before calculating SignatureV4 on their end.
     // This results in the signature getting calculated with a double encoded URL.
     // That means we have to double encode it here for the signature to match on the service side.
     if(urlEscapePath)
     {
         // RFC3986 is how we encode the URL before sending it on the wire.
-        auto rfc3986EncodedPath = URI::URLEncodePathRFC3986(uriCpy.GetPath());
-        uriCpy.SetPath(rfc3986EncodedPath);
         // However, SignatureV4 uses this URL encoding scheme
-        signingStringStream << NEWLINE << uriCpy.GetURLEncodedPath() << NEWLINE;
+        encodedPath = URI::URLEncodePath(URI::URLEncodePathRFC3986(request.GetUri().GetPath()));
     }
     else
     {
         // For the services that DO decode the URL first; we don't need to double encode it.
-        uriCpy.SetPath(uriCpy.GetURLEncodedPath());
-        signingStringStream << NEWLINE << uriCpy.GetPath() << NEWLINE;
+        request.GetUri().GetURLEncodedPath(encodedPath);
     }
 
-    if (request.GetQueryString().size() > 1 && request.GetQueryString().find("=") != std::string::npos)
+    builder.BeginCanonicalRequest(HttpMethodMapper::GetNameForHttpMethod(request.GetMethod()), encodedPath,
+                                  request.GetQueryString(), &digest, keepCanonicalRequest);
+}
+
+// the canonical request is only kept around when somebody is going to log it.
+static bool IsDebugLogging()
+{
+#ifdef DISABLE_LOGGING
+    return false;
+#else
+    LogSystemInterface* logSystem = GetLogSystem();
+    return logSystem && logSystem->GetLogLevel() >= LogLevel::Debug;
+#endif
+}
+
+static string GetUUID()
+{
+    return NonceGenerator::GenerateHex();
+}
+
+static vector<string> GetUUIDs(size_t count)
+{
+    vector<string> uuids;
+    uuids.reserve(count);
+
+    //the random bytes for the whole batch at once, a nonce is 16 of them.
+    vector<unsigned char> random(count * NonceGenerator::NONCE_LENGTH);
+    if (count > 0 && NonceGenerator::Generate(random.data(), count))
     {
-        signingStringStream << request.GetQueryString().substr(1) << NEWLINE;
+        for (size_t i = 0; i < count; ++i)
+        {
+            uuids.push_back(HashingUtils::HexEncode(random.data() + i * NonceGenerator::NONCE_LENGTH,
+                                                    NonceGenerator::NONCE_LENGTH));
+        }
     }
-    else if (request.GetQueryString().size() > 1)
+    return uuids;
+}
+
+bool JdcloudSignerImpl::SignRequest(HttpRequest& request) const
+{
+    return SignRequest(request, nullptr);
+}
+
+bool JdcloudSignerImpl::SignRequest(HttpRequest& request, const DateTime& now, const string& uuid) const
+{
+    return SignRequest(request, nullptr, now, uuid);
+}
+
+bool JdcloudSignerImpl::SignRequest(HttpRequest& request, const PreparedRequest& prepared) const
+{
+    return SignRequest(request, &prepared);
+}
+
+bool JdcloudSignerImpl::SignRequest(HttpRequest& request, const PreparedRequest& prepared, const DateTime& now,
+                                    const string& uuid) const
+{
+    return SignRequest(request, &prepared, now, uuid);
+}
+
+bool JdcloudSignerImpl::SignRequest(HttpRequest& request, const PreparedRequest* prepared) const
+{
+    DateTime now = GetSigningTimestamp();
+    auto uuid = GetUUID();
+    if (uuid.empty())
     {
-        signingStringStream << request.GetQueryString().substr(1) << "=" << NEWLINE;
+        LOGSTREAM_ERROR(logTag, "Failed to generate a nonce");
+        return false;
     }
-    else
+    return SignRequest(request, prepared, now, uuid);
+}
+
+bool JdcloudSignerImpl::SignRequest(HttpRequest& request, const PreparedRequest* prepared, const DateTime& now,
+                                    const string& uuid) const
+{
+    //one context per thread, so signing one request at a time reuses its buffers as a batch would.
+    static thread_local SigningContext context;
+    if (!PrepareSigningContext(now, context))
     {
-        signingStringStream << NEWLINE;
+        return false;
     }
 
-    return signingStringStream.str();
+    return SignRequest(request, uuid, context, prepared);
 }
 
-#ifdef WIN32
-static string GetUUID()
+PreparedRequest JdcloudSignerImpl::PrepareRequest(const HttpRequest& request) const
 {
-    GUID guid;
-    char buf[64] = { 0 };
-    CoCreateGuid(&guid);
-    _snprintf_s(buf,
-        sizeof(buf),
-        "{%08X%04X%04X%2X%02X%02X%02X%02X%02X%02X%02X}",
-        guid.Data1, guid.Data2, guid.Data3,
-        guid.Data4[0], guid.Data4[1],
-        guid.Data4[2], guid.Data4[3],
-        guid.Data4[4], guid.Data4[5],
-        guid.Data4[6], guid.Data4[7]);
-    return std::string(buf);
+    PreparedRequest prepared;
+
+    URI uri = request.GetUri();
+    prepared.m_path = uri.GetPath().ToString();
+    prepared.m_encodedPath = uri.GetURLEncodedPath();
+    prepared.m_queryString = uri.GetQueryString().ToString();
+    uri.CanonicalizeQueryString();
+    prepared.m_canonicalQueryString = uri.GetQueryString().ToString();
+
+    for (const auto& header : request.GetHeaders())
+    {
+        //the date and nonce change with every signature, there is nothing to reuse.
+        if (header.first == DATE_HEADER || header.first == NONCE_HEADER || !IsTrimmedHeaderName(header.first)
+            || !ShouldSignHeader(header.first))
+        {
+            continue;
+        }
+        prepared.m_headers.push_back({header.first, header.second, header.GetCanonicalValue()});
+    }
+
+    return prepared;
 }
-#else
-static string GetUUID()
+
+vector<bool> JdcloudSignerImpl::SignRequests(HttpRequest* requests, size_t count) const
 {
-    uuid_t uuid;
-    //The UUID is 16 bytes (128 bits) long
-    uuid_generate(uuid);
+    DateTime now = GetSigningTimestamp();
+    return SignRequests(requests, count, now, GetUUIDs(count));
+}
+
+vector<bool> JdcloudSignerImpl::SignRequests(HttpRequest* requests, size_t count, const DateTime& now,
+                                             const vector<string>& uuids) const
+{
+    vector<bool> results(count, false);
+    if (uuids.size() < count)
+    {
+        LOGSTREAM_ERROR(logTag, "Got " << uuids.size() << " nonces to sign " << count << " requests");
+        return results;
+    }
 
-    return HashingUtils::HexEncode((unsigned char *)uuid, 16);
+    SigningContext context;
+    if (!PrepareSigningContext(now, context))
+    {
+        return results;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        results[i] = SignRequest(requests[i], uuids[i], context);
+    }
+    return results;
 }
-#endif
 
-bool JdcloudSignerImpl::SignRequest(HttpRequest& request) const
+vector<bool> JdcloudSignerImpl::SignRequests(HttpRequest* requests, size_t count, size_t threadCount) const
 {
     DateTime now = GetSigningTimestamp();
-    auto uuid = GetUUID();
-    return SignRequest(request, now, uuid);
+    return SignRequests(requests, count, threadCount, now, GetUUIDs(count));
 }
 
+vector<bool> JdcloudSignerImpl::SignRequests(HttpRequest* requests, size_t count, size_t threadCount,
+                                             const DateTime& now, const vector<string>& uuids) const
+{
+    if (threadCount <= 1 || count < 2)
+    {
+        return SignRequests(requests, count, now, uuids);
+    }
 
-bool JdcloudSignerImpl::SignRequest(HttpRequest& request, const DateTime& now, const string& uuid) const
+    vector<bool> results(count, false);
+    if (uuids.size() < count)
+    {
+        LOGSTREAM_ERROR(logTag, "Got " << uuids.size() << " nonces to sign " << count << " requests");
+        return results;
+    }
+
+    SigningContext sharedContext;
+    if (!PrepareSigningContext(now, sharedContext))
+    {
+        return results;
+    }
+
+    //every worker signs with its own context so they share no hashing state or scratch buffers.
+    vector<SigningContext> contexts(threadCount < count ? threadCount : count, sharedContext);
+    //vector<bool> packs bits, so the workers write bytes and the result is copied afterwards.
+    vector<char> signedFlags(count, 0);
+
+    WorkStealingScheduler::Run(count, contexts.size(), [&](size_t worker, size_t index) {
+        signedFlags[index] = SignRequest(requests[index], uuids[index], contexts[worker]) ? 1 : 0;
+    });
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        results[i] = signedFlags[i] != 0;
+    }
+    return results;
+}
+
+bool JdcloudSignerImpl::PrepareSigningContext(const DateTime& now, SigningContext& context) const
 {
     //don't sign anonymous requests
     if (m_credential.GetAccessKey().empty() || m_credential.GetSecretKey().empty())
@@ -176,98 +287,314 @@ bool JdcloudSignerImpl::SignRequest(HttpRequest& request, const DateTime& now, c
         return false;
     }
 
-    string payloadHash(UNSIGNED_PAYLOAD);
-    payloadHash.assign(ComputePayloadHash(request));
-    if (payloadHash.empty())
+    //calculate date header to use in internal signature (this also goes into date header).
+    SigningDates dates;
+    now.ToSigningDates(dates);
+    context.dateHeaderValue.assign(dates.longDate, SigningDates::LONG_DATE_LENGTH);
+    context.simpleDate.assign(dates.shortDate, SigningDates::SHORT_DATE_LENGTH);
+    context.credentialScope.assign(context.simpleDate).append("/").append(m_region).append("/")
+        .append(m_serviceName).append("/").append(JDCLOUD_REQUEST);
+    context.signingKey = GetSigningKey(context.simpleDate);
+    return true;
+}
+
+// a body chunked when the request was signed before goes back to the plain one, to be read again from its start.
+static void UnwrapChunkedBody(HttpRequest& request)
+{
+    auto chunked = dynamic_cast<ChunkedSigningStream*>(request.GetContentBody().get());
+    if (!chunked)
     {
-        return false;
+        return;
     }
 
-    //calculate date header to use in internal signature (this also goes into date header).
-    string dateHeaderValue = now.ToGmtString(LONG_DATE_FORMAT_STR);
-    request.SetHeaderValue(DATE_HEADER, dateHeaderValue);
-    request.SetHeaderValue(NONCE_HEADER, uuid);
+    //a body that cannot seek is still where it was, as long as none of it was sent.
+    shared_ptr<iostream> source = chunked->GetSource();
+    source->clear();
+    bool seekable = SpooledBodyStream::IsSeekable(*source);
+    if (seekable)
+    {
+        source->seekg(0);
+    }
+    request.AddContentBody(source);
 
-    std::stringstream headersStream;
-    std::stringstream signedHeadersStream;
+    //and the headers that described the framing go back to describing the body. Only the caller knows the
+    //length of a body that cannot seek, so it is kept for signing it again.
+    string decodedLength = request.GetHeaderValue(DECODED_CONTENT_LENGTH_HEADER);
+    request.SetHeaderValue(CONTENT_LENGTH_HEADER, decodedLength);
+    if (seekable)
+    {
+        request.DeleteHeader(DECODED_CONTENT_LENGTH_HEADER);
+    }
+    request.DeleteHeader(CONTENT_SHA256_HEADER);
+    request.DeleteHeader(AUTHORIZATION_HEADER);
+    string encoding = request.GetHeaderValue(CONTENT_ENCODING_HEADER);
+    if (encoding.compare(0, strlen(CHUNKED_CONTENT_ENCODING), CHUNKED_CONTENT_ENCODING) != 0)
+    {
+        return;
+    }
+    StringView rest = StringView(encoding).substr(strlen(CHUNKED_CONTENT_ENCODING));
+    rest = StringUtils::LTrimView(rest.substr(rest.find(',') == 0 ? 1 : 0));
+    if (rest.empty())
+    {
+        request.DeleteHeader(CONTENT_ENCODING_HEADER);
+    }
+    else
+    {
+        request.SetHeaderValue(CONTENT_ENCODING_HEADER, rest.ToString());
+    }
+}
 
-    for (const auto& header : CanonicalizeHeaders(request.GetHeaders()))
+// the bytes of the body that will be sent, from x-jdcloud-decoded-content-length or by seeking a body that can.
+static bool GetDecodedContentLength(HttpRequest& request, uint64_t& length)
+{
+    const string& decodedLength = request.GetHeaderValue(DECODED_CONTENT_LENGTH_HEADER);
+    if (!decodedLength.empty())
     {
-        if(ShouldSignHeader(header.first))
-        {
-            headersStream << header.first.c_str() << ":" << header.second.c_str() << NEWLINE;
-            signedHeadersStream << header.first.c_str() << ";";
-        }
+        char* end = nullptr;
+        length = strtoull(decodedLength.c_str(), &end, 10);
+        return *end == '\0' && isdigit(static_cast<unsigned char>(decodedLength.front()));
     }
 
-    string canonicalHeadersString = headersStream.str();
-    LOGSTREAM_DEBUG(logTag, "Canonical Header String: \n" << canonicalHeadersString);
+    iostream& body = *request.GetContentBody();
+    if (!SpooledBodyStream::IsSeekable(body))
+    {
+        return false;
+    }
+    body.clear();
+    auto bodyEnd = body.rdbuf()->pubseekoff(0, ios_base::end, ios_base::in);
+    //the chunks are read from the start, as the hash of a signed body is.
+    body.seekg(0);
+    if (bodyEnd == iostream::pos_type(iostream::off_type(-1)) || body.fail())
+    {
+        return false;
+    }
+    length = static_cast<uint64_t>(static_cast<iostream::off_type>(bodyEnd));
+    return true;
+}
 
-    //calculate signed headers parameter
-    string signedHeadersValue = signedHeadersStream.str();
-    //remove that last semi-colon
-    if (!signedHeadersValue.empty())
+static bool SetStreamingHeaders(HttpRequest& request)
+{
+    uint64_t length;
+    if (!GetDecodedContentLength(request, length))
     {
-        signedHeadersValue.pop_back();
+        LOGSTREAM_ERROR(logTag, "Streaming the payload needs its length: a seekable body or the "
+                        << DECODED_CONTENT_LENGTH_HEADER << " header.");
+        return false;
     }
 
-    LOGSTREAM_DEBUG(logTag, "Signed Headers value:" << signedHeadersValue);
+    request.SetHeaderValue(CONTENT_SHA256_HEADER, STREAMING_PAYLOAD);
+    request.SetHeaderValue(DECODED_CONTENT_LENGTH_HEADER, to_string(length));
+    request.SetHeaderValue(CONTENT_LENGTH_HEADER, to_string(ChunkedSigningStreambuf::GetEncodedLength(length)));
+    const string& encoding = request.GetHeaderValue(CONTENT_ENCODING_HEADER);
+    if (encoding.empty())
+    {
+        request.SetHeaderValue(CONTENT_ENCODING_HEADER, CHUNKED_CONTENT_ENCODING);
+    }
+    else if (encoding.compare(0, strlen(CHUNKED_CONTENT_ENCODING), CHUNKED_CONTENT_ENCODING) != 0)
+    {
+        request.SetHeaderValue(CONTENT_ENCODING_HEADER, string(CHUNKED_CONTENT_ENCODING) + "," + encoding);
+    }
+    return true;
+}
 
-    //generate generalized canonicalized request string.
-    string canonicalRequestString = CanonicalizeRequestSigningString(request, false);
+// SetPayloadHash lower-cases what it is given.
+static bool IsHexSha256(const string& hash)
+{
+    return hash.size() == Sha256HexDigest::LENGTH
+           && all_of(hash.begin(), hash.end(), [](char c) { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'); });
+}
 
-    //append v4 stuff to the canonical request string.
-    canonicalRequestString.append(canonicalHeadersString);
-    canonicalRequestString.append(NEWLINE);
-    canonicalRequestString.append(signedHeadersValue);
-    canonicalRequestString.append(NEWLINE);
-    canonicalRequestString.append(payloadHash);
+static bool IsStreaming(const HttpRequest& request)
+{
+    return request.GetPayloadSigning() == PayloadSigning::STREAMING && request.GetContentBody();
+}
 
-    LOGSTREAM_DEBUG(logTag, "Canonical Request String: \n" << canonicalRequestString);
+bool JdcloudSignerImpl::SignRequest(HttpRequest& request, const string& uuid, SigningContext& context,
+                                    const PreparedRequest* prepared) const
+{
+    UnwrapChunkedBody(request);
 
-    //now compute sha256 on that request string
-    auto hashResult = m_hash->Calculate(canonicalRequestString);
+    StringView payloadHash;
+    if (!ComputePayloadHash(request, context.hash, payloadHash))
+    {
+        return false;
+    }
+
+    request.SetHeaderValue(DATE_HEADER, context.dateHeaderValue);
+    request.SetHeaderValue(NONCE_HEADER, uuid);
+    if (IsStreaming(request) && !SetStreamingHeaders(request))
+    {
+        return false;
+    }
+
+    CanonicalRequestBuilder& builder = context.builder;
+    if (prepared)
+    {
+        BeginPreparedCanonicalRequest(request, *prepared, context);
+    }
+    else
+    {
+        BeginCanonicalRequest(request, false, builder, context.hash, IsDebugLogging(), context.encodedPath);
+    }
+    AppendCanonicalHeaders(request.GetHeaders(), prepared, builder);
+
+    builder.EndCanonicalRequest(payloadHash);
+
+    LOGSTREAM_DEBUG(logTag, "Signed Headers value:" << builder.GetSignedHeaders());
+    LOGSTREAM_DEBUG(logTag, "Canonical Request String: \n" << builder.GetCanonicalRequest());
+
+    //the request string was hashed while it was built
+    auto hashResult = context.hash.Finish();
     if (!hashResult.IsSuccess())
     {
         LOGSTREAM_ERROR(logTag, "Failed to hash (sha256) request string");
-        LOGSTREAM_DEBUG(logTag, "The request string is: \"" << canonicalRequestString << "\"");
+        LOGSTREAM_DEBUG(logTag, "The request string is: \"" << builder.GetCanonicalRequest() << "\"");
         return false;
     }
 
-    string cannonicalRequestHash = hashResult.GetResult();
-    string simpleDate = now.ToGmtString(SIMPLE_DATE_FORMAT_STR);
+    Sha256HexDigest canonicalRequestHash(hashResult.GetResult());
+    builder.BuildStringToSign(HMAC_SHA256, context.dateHeaderValue, context.credentialScope, canonicalRequestHash);
+    auto finalSignature = GenerateSignature(builder.GetStringToSign(), context.signingKey);
 
-    string stringToSign = GenerateStringToSign(dateHeaderValue, simpleDate, cannonicalRequestHash, m_region,
-                                                    m_serviceName);
-    auto finalSignature = GenerateSignature(m_credential, stringToSign, simpleDate);
+    builder.BuildAuthorization(HMAC_SHA256, m_credential.GetAccessKey(), context.credentialScope, finalSignature);
+    LOGSTREAM_DEBUG(logTag, "Signing request with: " << builder.GetAuthorization());
+    StringView authorization = builder.GetAuthorization();
+    context.authorization.assign(authorization.data(), authorization.size());
+    request.SetAuthorization(context.authorization);
 
-    stringstream ss;
-    ss << HMAC_SHA256 << " " << CREDENTIAL << EQ << m_credential.GetAccessKey() << "/" << simpleDate
-        << "/" << m_region << "/" << m_serviceName << "/" << JDCLOUD_REQUEST << ", " << SIGNED_HEADERS << EQ
-        << signedHeadersValue << ", " << SIGNATURE << EQ << finalSignature;
-
-    auto authString = ss.str();
-    LOGSTREAM_DEBUG(logTag, "Signing request with: " << authString);
-    request.SetAuthorization(authString);
+    if (IsStreaming(request))
+    {
+        //the chunks are signed as they are read, starting from the request signature.
+        request.AddContentBody(make_shared<ChunkedSigningStream>(request.GetContentBody(), context.dateHeaderValue,
+                                                                 context.credentialScope, context.signingKey,
+                                                                 finalSignature));
+    }
 
     return true;
 }
 
+void JdcloudSignerImpl::BeginPreparedCanonicalRequest(HttpRequest& request, const PreparedRequest& prepared,
+                                                      SigningContext& context) const
+{
+    URI& uri = request.GetUri();
+    StringView queryString = uri.GetQueryString();
+    if (queryString != prepared.m_canonicalQueryString)
+    {
+        if (queryString == prepared.m_queryString)
+        {
+            uri.SetQueryString(prepared.m_canonicalQueryString);
+        }
+        else
+        {
+            request.CanonicalizeRequest();
+        }
+    }
+
+    bool samePath = uri.GetPath() == prepared.m_path;
+    if (!samePath)
+    {
+        uri.GetURLEncodedPath(context.encodedPath);
+    }
+
+    CanonicalRequestBuilder& builder = context.builder;
+    builder.BeginCanonicalRequest(HttpMethodMapper::GetNameForHttpMethod(request.GetMethod()),
+                                  samePath ? prepared.m_encodedPath : context.encodedPath, uri.GetQueryString(),
+                                  &context.hash, IsDebugLogging());
+}
+
+void JdcloudSignerImpl::AppendCanonicalHeaders(const HeaderValueCollection& headers, const PreparedRequest* prepared,
+                                               CanonicalRequestBuilder& builder) const
+{
+    //names that trim down to another header's name have to be merged, which takes the full canonicalization.
+    if (!all_of(headers.begin(), headers.end(),
+                [](const HeaderValueEntry& header) { return IsTrimmedHeaderName(header.first); }))
+    {
+        for (const auto& header : CanonicalizeHeaders(headers))
+        {
+            if(ShouldSignHeader(header.first))
+            {
+                builder.AppendHeader(header.first, header.second);
+            }
+        }
+        return;
+    }
+
+    //both are in header name order, so the cached headers are walked alongside the request ones.
+    const PreparedRequest::Header* cached = prepared ? prepared->m_headers.data() : nullptr;
+    const PreparedRequest::Header* cachedEnd = prepared ? cached + prepared->m_headers.size() : nullptr;
+    for (const auto& header : headers)
+    {
+        if (!ShouldSignHeader(header.first))
+        {
+            continue;
+        }
+
+        while (cached != cachedEnd && cached->name < header.first)
+        {
+            ++cached;
+        }
+        if (cached != cachedEnd && cached->name == header.first && cached->value == header.second)
+        {
+            builder.AppendHeader(header.first, cached->canonicalValue);
+        }
+        else
+        {
+            builder.AppendHeader(header.first, header.GetCanonicalValue());
+        }
+    }
+}
+
 bool JdcloudSignerImpl::ShouldSignHeader(const string& header) const
 {
     return m_unsignedHeaders.find(header.c_str()) == m_unsignedHeaders.cend();
 }
 
-string JdcloudSignerImpl::ComputePayloadHash(HttpRequest& request) const
+bool JdcloudSignerImpl::ComputePayloadHash(HttpRequest& request, Sha256& hash, StringView& payloadHash) const
 {
+    if (request.GetPayloadSigning() == PayloadSigning::UNSIGNED)
+    {
+        payloadHash = UNSIGNED_PAYLOAD;
+        LOGSTREAM_DEBUG(logTag, "Using " << payloadHash << " because the payload is not signed.");
+        return true;
+    }
+
+    if (IsStreaming(request))
+    {
+        payloadHash = STREAMING_PAYLOAD;
+        LOGSTREAM_DEBUG(logTag, "Using " << payloadHash << " because the payload is signed in chunks.");
+        return true;
+    }
+
     if (!request.GetContentBody())
     {
-        LOGSTREAM_DEBUG(logTag, "Using cached empty string sha256 " << EMPTY_STRING_SHA256 << " because payload is empty.");
-        return EMPTY_STRING_SHA256;
+        static const Sha256HexDigest emptyStringHash{Sha256Digest(EMPTY_STRING_SHA256)};
+        payloadHash = emptyStringHash;
+        LOGSTREAM_DEBUG(logTag, "Using cached empty string sha256 " << payloadHash << " because payload is empty.");
+        return true;
+    }
+
+    //set by the caller, or computed when this body was signed before.
+    const string& knownHash = request.GetPayloadHash();
+    if (IsHexSha256(knownHash))
+    {
+        payloadHash = knownHash;
+        LOGSTREAM_DEBUG(logTag, "Using known sha256 " << payloadHash << " for payload.");
+        return true;
+    }
+    if (!knownHash.empty())
+    {
+        LOGSTREAM_WARN(logTag, "Ignoring payload hash " << knownHash << " which is not a hex sha256.");
+    }
+
+    //a body that cannot seek back is read through a copy, which is what gets sent after hashing it.
+    if (!SpooledBodyStream::IsSeekable(*request.GetContentBody()))
+    {
+        LOGSTREAM_DEBUG(logTag, "Spooling the payload, which cannot seek, while hashing it.");
+        request.AddContentBody(make_shared<SpooledBodyStream>(request.GetContentBody()));
     }
 
     //compute hash on payload if it exists.
-    auto hashResult = m_hash->Calculate(*request.GetContentBody());
+    auto hashResult = hash.Calculate(*request.GetContentBody());
 
     if(request.GetContentBody())
     {
@@ -275,63 +602,57 @@ string JdcloudSignerImpl::ComputePayloadHash(HttpRequest& request) const
         request.GetContentBody()->seekg(0);
     }
 
-    if (!hashResult.IsSuccess())
+    //a copy that could not be written or read back ends early, which hashes as a shorter body.
+    auto spooled = dynamic_cast<SpooledBodyStream*>(request.GetContentBody().get());
+    if (!hashResult.IsSuccess() || (spooled && spooled->HasFailed()))
     {
         LOGSTREAM_ERROR(logTag, "Unable to hash (sha256) request body");
-        return "";
+        return false;
     }
 
-    auto sha256Digest = hashResult.GetResult();
-
-    string payloadHash(sha256Digest);
+    request.SetPayloadHash(Sha256HexDigest(hashResult.GetResult()).ToString());
+    payloadHash = request.GetPayloadHash();
     LOGSTREAM_DEBUG(logTag, "Calculated sha256 " << payloadHash << " for payload.");
-    return payloadHash;
+    return true;
 }
 
 
-string JdcloudSignerImpl::GenerateStringToSign(const string& dateValue, const string& simpleDate,
-                                            const string& canonicalRequestHash, const string& region, const string& serviceName) const
+Sha256HMACMidstate JdcloudSignerImpl::GetSigningKey(const string& simpleDate) const
 {
-    //generate the actual string we will use in signing the final request.
-    stringstream ss;
-
-    ss << HMAC_SHA256 << NEWLINE << dateValue << NEWLINE << simpleDate << "/" << region << "/"
-        << serviceName << "/" << JDCLOUD_REQUEST << NEWLINE << canonicalRequestHash;
-
-    return ss.str();
-}
-
-string JdcloudSignerImpl::GenerateSignature(const Credential& credentials, const string& stringToSign,
-                                        const string& simpleDate) const
-{
-    auto key = ComputeHash(credentials.GetSecretKey(), simpleDate, m_region, m_serviceName);
-    return GenerateSignature(stringToSign, key);
+    Sha256HMACMidstate key;
+    if (!m_signingKeyCache->Get(m_signingKeyId, simpleDate, key))
+    {
+        auto derivedKey = ComputeHash(m_credential.GetSecretKey(), simpleDate, m_region, m_serviceName);
+        if (derivedKey.IsSuccess())
+        {
+            key = Sha256HMACMidstate(derivedKey.GetResult());
+            m_signingKeyCache->Put(m_signingKeyId, simpleDate, key);
+        }
+    }
+    return key;
 }
 
-string JdcloudSignerImpl::GenerateSignature(const string& stringToSign, const string& key) const
+Sha256HexDigest JdcloudSignerImpl::GenerateSignature(StringView stringToSign, const Sha256HMACMidstate& key) const
 {
     LOGSTREAM_DEBUG(logTag, "Final String to sign: \n" << stringToSign);
 
-    stringstream ss;
-
-    auto hashResult = m_hmac->Calculate(stringToSign, key);
+    auto hashResult = key.Calculate(stringToSign.data(), stringToSign.size());
     if (!hashResult.IsSuccess())
     {
         LOGSTREAM_ERROR(logTag, "Unable to hmac (sha256) final string");
         LOGSTREAM_DEBUG(logTag, "The final string is: \"" << stringToSign << "\"");
-        return "";
+        return Sha256HexDigest();
     }
 
     //now we finally sign our request string with our hex encoded derived hash.
-    string result = hashResult.GetResult();
-    string finalSigningHash = HashingUtils::HexEncode((unsigned char*)result.c_str(), result.length());
+    Sha256HexDigest finalSigningHash(hashResult.GetResult());
     LOGSTREAM_DEBUG(logTag, "Final computed signing hash: " << finalSigningHash);
 
     return finalSigningHash;
 }
 
-string JdcloudSignerImpl::ComputeHash(const string& secretKey, const string& simpleDate, const string& region,
-                                const string& serviceName) const
+HashResult JdcloudSignerImpl::ComputeHash(const string& secretKey, const string& simpleDate, const string& region,
+                                          const string& serviceName) const
 {
     string signingKey(SIGNING_KEY);
     signingKey.append(secretKey);
@@ -340,34 +661,34 @@ string JdcloudSignerImpl::ComputeHash(const string& secretKey, const string& sim
     if (!hashResult.IsSuccess())
     {
         LOGSTREAM_ERROR(logTag, "Failed to HMAC (SHA256) date string \"" << simpleDate << "\"");
-        return {};
+        return hashResult;
     }
 
-    auto kDate = hashResult.GetResult();
+    Sha256Digest kDate = hashResult.GetResult();
     hashResult = m_hmac->Calculate(region, kDate);
     if (!hashResult.IsSuccess())
     {
         LOGSTREAM_ERROR(logTag, "Failed to HMAC (SHA256) region string \"" << region << "\"");
-        return {};
+        return hashResult;
     }
 
-    auto kRegion = hashResult.GetResult();
+    Sha256Digest kRegion = hashResult.GetResult();
     hashResult = m_hmac->Calculate(serviceName, kRegion);
     if (!hashResult.IsSuccess())
     {
         LOGSTREAM_ERROR(logTag, "Failed to HMAC (SHA256) service string \"" << m_serviceName << "\"");
-        return {};
+        return hashResult;
     }
 
-    auto kService = hashResult.GetResult();
+    Sha256Digest kService = hashResult.GetResult();
     hashResult = m_hmac->Calculate(JDCLOUD_REQUEST, kService);
     if (!hashResult.IsSuccess())
     {
         LOGSTREAM_ERROR(logTag, "Unable to HMAC (SHA256) request string");
         LOGSTREAM_DEBUG(logTag, "The request string is: \"" << JDCLOUD_REQUEST << "\"");
-        return {};
+        return hashResult;
     }
-    return hashResult.GetResult();
+    return hashResult;
 }
 
 }
@@ -0,0 +1,238 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "jdcloud_signer/SigningKeyCache.h"
+
+#include <cstring>
+#include "jdcloud_signer/util/crypto/Sha256HMAC.h"
+
+using namespace std;
+
+namespace jdcloud_signer {
+
+const size_t SigningKeyCache::SLOT_COUNT;
+const size_t SigningKeyCache::ID_LENGTH;
+
+static const char* SIGNING_KEY_ID_CONTEXT = "jdcloud2_signing_key_cache";
+
+SigningKeyCache::SigningKeyCache() :
+    m_latestDay(0)
+{
+    for (auto& slot : m_slots)
+    {
+        slot.sequence.store(0, memory_order_relaxed);
+        slot.day.store(0, memory_order_relaxed);
+        for (auto& word : slot.id)
+        {
+            word.store(0, memory_order_relaxed);
+        }
+        for (auto& word : slot.inner)
+        {
+            word.store(0, memory_order_relaxed);
+        }
+        for (auto& word : slot.outer)
+        {
+            word.store(0, memory_order_relaxed);
+        }
+    }
+}
+
+SigningKeyCache& SigningKeyCache::GetDefault()
+{
+    static SigningKeyCache cache;
+    return cache;
+}
+
+string SigningKeyCache::MakeSigningKeyId(const string& secretKey, const string& region, const string& serviceName)
+{
+    string context(SIGNING_KEY_ID_CONTEXT);
+    context.append("\n").append(region).append("\n").append(serviceName);
+
+    Sha256HMAC hmac;
+    auto hashResult = hmac.Calculate(context, secretKey);
+    if (!hashResult.IsSuccess() || hashResult.GetResult().size() != ID_LENGTH)
+    {
+        return {};
+    }
+    return hashResult.GetResult().ToString();
+}
+
+bool SigningKeyCache::Get(const string& signingKeyId, const string& simpleDate, Sha256HMACMidstate& derivedKey) const
+{
+    uint32_t day = ParseDay(simpleDate);
+    if (day == 0 || signingKeyId.size() != ID_LENGTH)
+    {
+        return false;
+    }
+
+    uint64_t id[ID_WORDS];
+    memcpy(id, signingKeyId.data(), ID_LENGTH);
+
+    size_t first = FirstSlot(id);
+    for (size_t probe = 0; probe < PROBE_LENGTH; ++probe)
+    {
+        const Slot& slot = m_slots[(first + probe) % SLOT_COUNT];
+
+        uint32_t sequence = slot.sequence.load(memory_order_acquire);
+        if (sequence & 1)
+        {
+            // a writer owns the slot right now, treat it as a miss rather than wait.
+            continue;
+        }
+
+        bool matches = slot.day.load(memory_order_relaxed) == day;
+        for (size_t i = 0; i < ID_WORDS; ++i)
+        {
+            matches = slot.id[i].load(memory_order_relaxed) == id[i] && matches;
+        }
+        uint64_t inner[STATE_WORDS];
+        uint64_t outer[STATE_WORDS];
+        for (size_t i = 0; i < STATE_WORDS; ++i)
+        {
+            inner[i] = slot.inner[i].load(memory_order_relaxed);
+            outer[i] = slot.outer[i].load(memory_order_relaxed);
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        if (matches && slot.sequence.load(memory_order_relaxed) == sequence)
+        {
+            uint32_t innerState[SHA256_DIGEST_WORDS];
+            uint32_t outerState[SHA256_DIGEST_WORDS];
+            memcpy(innerState, inner, sizeof(innerState));
+            memcpy(outerState, outer, sizeof(outerState));
+            derivedKey = Sha256HMACMidstate(innerState, outerState);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void SigningKeyCache::Put(const string& signingKeyId, const string& simpleDate, const Sha256HMACMidstate& derivedKey)
+{
+    uint32_t day = ParseDay(simpleDate);
+    if (day == 0 || signingKeyId.size() != ID_LENGTH || !derivedKey.IsValid())
+    {
+        return;
+    }
+
+    uint64_t id[ID_WORDS];
+    uint64_t inner[STATE_WORDS];
+    uint64_t outer[STATE_WORDS];
+    memcpy(id, signingKeyId.data(), ID_LENGTH);
+    memcpy(inner, derivedKey.GetInnerState(), sizeof(inner));
+    memcpy(outer, derivedKey.GetOuterState(), sizeof(outer));
+
+    lock_guard<mutex> lock(m_writeMutex);
+
+    if (day > m_latestDay)
+    {
+        // a new day started, the keys derived for the days before it will not be asked for again.
+        for (auto& slot : m_slots)
+        {
+            uint32_t slotDay = slot.day.load(memory_order_relaxed);
+            if (slotDay != 0 && slotDay < day)
+            {
+                uint64_t empty[STATE_WORDS] = {0};
+                WriteSlot(slot, 0, empty, empty, empty);
+            }
+        }
+        m_latestDay = day;
+    }
+
+    size_t first = FirstSlot(id);
+    Slot* victim = &m_slots[first];
+    for (size_t probe = 0; probe < PROBE_LENGTH; ++probe)
+    {
+        Slot& slot = m_slots[(first + probe) % SLOT_COUNT];
+        uint32_t slotDay = slot.day.load(memory_order_relaxed);
+
+        bool sameId = true;
+        for (size_t i = 0; i < ID_WORDS; ++i)
+        {
+            sameId = slot.id[i].load(memory_order_relaxed) == id[i] && sameId;
+        }
+
+        if (slotDay == 0 || (sameId && slotDay <= day))
+        {
+            victim = &slot;
+            break;
+        }
+        if (slotDay < victim->day.load(memory_order_relaxed))
+        {
+            victim = &slot;
+        }
+    }
+
+    WriteSlot(*victim, day, id, inner, outer);
+}
+
+void SigningKeyCache::Clear()
+{
+    lock_guard<mutex> lock(m_writeMutex);
+
+    uint64_t empty[STATE_WORDS] = {0};
+    for (auto& slot : m_slots)
+    {
+        WriteSlot(slot, 0, empty, empty, empty);
+    }
+    m_latestDay = 0;
+}
+
+uint32_t SigningKeyCache::ParseDay(const string& simpleDate)
+{
+    if (simpleDate.size() != 8)
+    {
+        return 0;
+    }
+
+    uint32_t day = 0;
+    for (char c : simpleDate)
+    {
+        if (c < '0' || c > '9')
+        {
+            return 0;
+        }
+        day = day * 10 + static_cast<uint32_t>(c - '0');
+    }
+    return day;
+}
+
+size_t SigningKeyCache::FirstSlot(const uint64_t* id) const
+{
+    // the id is a digest already, any of its words is evenly distributed.
+    return static_cast<size_t>(id[0] % SLOT_COUNT);
+}
+
+void SigningKeyCache::WriteSlot(Slot& slot, uint32_t day, const uint64_t* id, const uint64_t* inner, const uint64_t* outer)
+{
+    uint32_t sequence = slot.sequence.load(memory_order_relaxed);
+    slot.sequence.store(sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot.day.store(day, memory_order_relaxed);
+    for (size_t i = 0; i < ID_WORDS; ++i)
+    {
+        slot.id[i].store(id[i], memory_order_relaxed);
+    }
+    for (size_t i = 0; i < STATE_WORDS; ++i)
+    {
+        slot.inner[i].store(inner[i], memory_order_relaxed);
+        slot.outer[i].store(outer[i], memory_order_relaxed);
+    }
+
+    slot.sequence.store(sequence + 2, memory_order_release);
+}
+
+}
@@ -0,0 +1,216 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "jdcloud_signer/SpooledBodyStream.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+#include "jdcloud_signer/logging/LogMacros.h"
+
+using namespace std;
+
+namespace jdcloud_signer {
+
+const size_t SpooledBodyStreambuf::DEFAULT_MEMORY_LIMIT;
+const size_t SpooledBodyStreambuf::BUFFER_SIZE;
+
+static const char* logTag = "SpooledBodyStream";
+
+SpooledBodyStreambuf::SpooledBodyStreambuf(const shared_ptr<iostream>& source, size_t memoryLimit,
+                                           const FileOpener& openFile) :
+    m_source(source),
+    m_memoryLimit(memoryLimit),
+    m_openFile(openFile),
+    m_file(nullptr),
+    m_buffer(BUFFER_SIZE),
+    m_spooled(0),
+    m_position(0),
+    m_sourceDone(false),
+    m_failed(false)
+{
+}
+
+SpooledBodyStreambuf::~SpooledBodyStreambuf()
+{
+    if (m_file)
+    {
+        fclose(m_file);
+    }
+}
+
+//the copy can pass the 2 GiB a long reaches on some platforms.
+static bool SeekFile(FILE* file, uint64_t offset, int origin)
+{
+#ifdef _WIN32
+    return offset <= static_cast<uint64_t>(numeric_limits<__int64>::max())
+        && _fseeki64(file, static_cast<__int64>(offset), origin) == 0;
+#else
+    return offset <= static_cast<uint64_t>(numeric_limits<off_t>::max())
+        && fseeko(file, static_cast<off_t>(offset), origin) == 0;
+#endif
+}
+
+void SpooledBodyStreambuf::Spool(const char* data, size_t length)
+{
+    if (!m_file && m_memory.size() + length > m_memoryLimit)
+    {
+        m_file = m_openFile();
+        if (m_file && fwrite(m_memory.data(), 1, m_memory.size(), m_file) == m_memory.size())
+        {
+            string().swap(m_memory);
+        }
+        else
+        {
+            LOGSTREAM_WARN(logTag, "Unable to spool the request body to a temporary file, keeping it in memory");
+            if (m_file)
+            {
+                fclose(m_file);
+                m_file = nullptr;
+            }
+            m_memoryLimit = static_cast<size_t>(-1);
+        }
+    }
+
+    if (m_file)
+    {
+        if (!SeekFile(m_file, 0, SEEK_END) || fwrite(data, 1, length, m_file) != length)
+        {
+            //the first pass is still served from the source, but the copy of it is incomplete.
+            LOGSTREAM_ERROR(logTag, "Unable to write the request body to its temporary file");
+            m_failed = true;
+        }
+    }
+    else
+    {
+        m_memory.append(data, length);
+    }
+    m_spooled += length;
+}
+
+bool SpooledBodyStreambuf::ReadSpool()
+{
+    if (!m_file)
+    {
+        char* begin = &m_memory[0];
+        setg(begin + m_position, begin + m_position, begin + m_spooled);
+        return true;
+    }
+
+    size_t length = static_cast<size_t>(min<uint64_t>(m_spooled - m_position, m_buffer.size()));
+    if (!SeekFile(m_file, m_position, SEEK_SET) || fread(m_buffer.data(), 1, length, m_file) != length)
+    {
+        LOGSTREAM_ERROR(logTag, "Unable to read the request body back from its temporary file");
+        m_failed = true;
+        return false;
+    }
+    setg(m_buffer.data(), m_buffer.data(), m_buffer.data() + length);
+    return true;
+}
+
+bool SpooledBodyStreambuf::ReadSource()
+{
+    if (m_sourceDone)
+    {
+        return false;
+    }
+
+    m_source->read(m_buffer.data(), m_buffer.size());
+    size_t length = static_cast<size_t>(m_source->gcount());
+    if (length == 0)
+    {
+        if (m_source->bad())
+        {
+            LOGSTREAM_ERROR(logTag, "Unable to read the request body");
+            m_failed = true;
+        }
+        m_sourceDone = true;
+        return false;
+    }
+
+    Spool(m_buffer.data(), length);
+    setg(m_buffer.data(), m_buffer.data(), m_buffer.data() + length);
+    return true;
+}
+
+SpooledBodyStreambuf::int_type SpooledBodyStreambuf::underflow()
+{
+    m_position += egptr() - eback();
+    setg(nullptr, nullptr, nullptr);
+
+    if (m_position < m_spooled ? !ReadSpool() : !ReadSource())
+    {
+        return traits_type::eof();
+    }
+    return traits_type::to_int_type(*gptr());
+}
+
+SpooledBodyStreambuf::pos_type SpooledBodyStreambuf::seekoff(off_type off, ios_base::seekdir dir,
+                                                             ios_base::openmode which)
+{
+    uint64_t current = m_position + (gptr() - eback());
+    off_type target;
+    if (!(which & ios_base::in))
+    {
+        return pos_type(off_type(-1));
+    }
+    else if (dir == ios_base::beg)
+    {
+        target = off;
+    }
+    else if (dir == ios_base::cur)
+    {
+        target = static_cast<off_type>(current) + off;
+    }
+    else
+    {
+        //the end is not known until the source has been read through.
+        return pos_type(off_type(-1));
+    }
+
+    if (target < 0 || static_cast<uint64_t>(target) > m_spooled)
+    {
+        return pos_type(off_type(-1));
+    }
+    if (static_cast<uint64_t>(target) != current)
+    {
+        m_position = static_cast<uint64_t>(target);
+        setg(nullptr, nullptr, nullptr);
+    }
+    return pos_type(target);
+}
+
+SpooledBodyStreambuf::pos_type SpooledBodyStreambuf::seekpos(pos_type pos, ios_base::openmode which)
+{
+    return seekoff(off_type(pos), ios_base::beg, which);
+}
+
+SpooledBodyStream::SpooledBodyStream(const shared_ptr<iostream>& source, size_t memoryLimit,
+                                     const SpooledBodyStreambuf::FileOpener& openFile) :
+    iostream(nullptr),
+    m_buffer(source, memoryLimit, openFile)
+{
+    rdbuf(&m_buffer);
+}
+
+bool SpooledBodyStream::IsSeekable(iostream& stream)
+{
+    return stream.rdbuf() && stream.rdbuf()->pubseekoff(0, ios_base::cur, ios_base::in) != pos_type(off_type(-1));
+}
+
+}
@@ -0,0 +1,47 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdio>
+#include <cstring>
+#include "Benchmark.h"
+
+namespace jdcloud_signer {
+namespace bench {
+
+std::vector<BenchmarkCase>& Registry()
+{
+    static std::vector<BenchmarkCase> registry;
+    return registry;
+}
+
+}
+}
+
+using namespace jdcloud_signer::bench;
+
+// Usage: jdcloud_signer_bench [filter]
+// Runs every benchmark whose name contains filter, or all of them when no filter is given.
+int main(int argc, char **argv) {
+    const char* filter = argc > 1 ? argv[1] : "";
+
+    for (const auto& benchmark : Registry()) {
+        if (std::strstr(benchmark.name, filter) == nullptr) {
+            continue;
+        }
+        std::printf("%s\n", benchmark.name);
+        benchmark.function();
+    }
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace jdcloud_signer {
+namespace bench {
+
+typedef void (*BenchmarkFunction)();
+
+struct BenchmarkCase
+{
+    const char* name;
+    BenchmarkFunction function;
+};
+
+std::vector<BenchmarkCase>& Registry();
+
+struct BenchmarkRegistrar
+{
+    BenchmarkRegistrar(const char* name, BenchmarkFunction function)
+    {
+        Registry().push_back({name, function});
+    }
+};
+
+/**
+ * Runs body `iterations` times after a short warm up, prints the mean cost and returns it in nanoseconds.
+ */
+template<typename Body>
+double Measure(const char* label, size_t iterations, Body body)
+{
+    for (size_t i = 0; i < iterations / 10 + 1; ++i)
+    {
+        body();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        body();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double nanosPerOp = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    std::printf("  %-48s %12.1f ns/op (%zu iterations)\n", label, nanosPerOp, iterations);
+    return nanosPerOp;
+}
+
+}
+}
+
+#define JDCLOUD_BENCHMARK(name) \
+    static void name(); \
+    static ::jdcloud_signer::bench::BenchmarkRegistrar name##Registrar(#name, name); \
+    static void name()
@@ -0,0 +1,706 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+#include "jdcloud_signer/CanonicalRequestBuilder.h"
+#include "jdcloud_signer/JdcloudSigner.h"
+#include "jdcloud_signer/JdcloudSignerImpl.h"
+#include "jdcloud_signer/SigningKeyCache.h"
+#include "jdcloud_signer/util/crypto/HashingUtils.h"
+#include "jdcloud_signer/util/crypto/NonceGenerator.h"
+#include "jdcloud_signer/util/crypto/Sha256.h"
+#include "jdcloud_signer/util/crypto/Sha256HMAC.h"
+#include "jdcloud_signer/util/crypto/Sha256HMACMidstate.h"
+#include "jdcloud_signer/util/StringUtils.h"
+
+using namespace jdcloud_signer;
+using namespace jdcloud_signer::bench;
+using namespace std;
+
+static HttpRequest BuildRequest() {
+    HttpRequest request(URI("http://vm.cn-north-1.jdcloud-api.com/v1/regions/cn-north-1/instances?pageNumber=2&pageSize=10"), HttpMethod::HTTP_GET);
+    request.SetHeaderValue(CONTENT_TYPE_HEADER, "application/json");
+    request.SetHeaderValue(USER_AGENT_HEADER, "JdcloudSdkCpp/1.0.2 vm/0.7.4");
+    return request;
+}
+
+JDCLOUD_BENCHMARK(SignRequestPerCallEngineVsPersistent) {
+    const size_t iterations = 100000;
+    Credential credential("ak", "sk");
+    HttpRequest request = BuildRequest();
+
+    double perCall = Measure("engine constructed per call", iterations, [&]() {
+        JdcloudSignerImpl impl(credential, "vm", "cn-north-1");
+        impl.SignRequest(request);
+    });
+
+    JdcloudSigner signer(credential, "vm", "cn-north-1");
+    double persistent = Measure("persistent engine", iterations, [&]() {
+        signer.SignRequest(request);
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", perCall - persistent, 100.0 * (perCall - persistent) / perCall);
+}
+
+JDCLOUD_BENCHMARK(DerivedKeyComputeVsCache) {
+    const size_t iterations = 100000;
+    Sha256HMAC hmac;
+    SigningKeyCache cache;
+    string signingKeyId = SigningKeyCache::MakeSigningKeyId("sk", "cn-north-1", "vm");
+
+    auto derive = [&]() {
+        Sha256Digest kDate = hmac.Calculate("20090213", "JDCLOUD2sk").GetResult();
+        Sha256Digest kRegion = hmac.Calculate("cn-north-1", kDate).GetResult();
+        Sha256Digest kService = hmac.Calculate("vm", kRegion).GetResult();
+        return hmac.Calculate("jdcloud2_request", kService).GetResult();
+    };
+
+    double computed = Measure("four chained HMAC-SHA256", iterations, [&]() {
+        derive();
+    });
+
+    cache.Put(signingKeyId, "20090213", Sha256HMACMidstate(derive()));
+    Sha256HMACMidstate key;
+    double cached = Measure("cache hit", iterations, [&]() {
+        cache.Get(signingKeyId, "20090213", key);
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", computed - cached, 100.0 * (computed - cached) / computed);
+}
+
+JDCLOUD_BENCHMARK(FinalHmacPlainVsMidstate) {
+    const size_t iterations = 200000;
+    Sha256HMAC hmac;
+    string key(32, 'k');
+    string stringToSign = "JDCLOUD2-HMAC-SHA256\n20090213T233130Z\n20090213/cn-north-1/vm/jdcloud2_request\n"
+        "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+    Sha256HMACMidstate midstate(key);
+
+    double plain = Measure("Sha256HMAC::Calculate", iterations, [&]() {
+        hmac.Calculate(stringToSign, key);
+    });
+    double openssl = Measure("midstate, OpenSSL", iterations, [&]() {
+        midstate.Calculate(stringToSign, Sha256Implementation::OpenSSL);
+    });
+    Measure("midstate, builtin", iterations, [&]() {
+        midstate.Calculate(stringToSign, Sha256Implementation::Builtin);
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", plain - openssl, 100.0 * (plain - openssl) / plain);
+}
+
+JDCLOUD_BENCHMARK(SignRequestsBatchVsOneByOne) {
+    const size_t batchSize = 1000;
+    const size_t iterations = 50;
+    Credential credential("ak", "sk");
+    JdcloudSigner signer(credential, "vm", "cn-north-1");
+    vector<HttpRequest> requests(batchSize, BuildRequest());
+
+    double oneByOne = Measure("SignRequest x1000", iterations, [&]() {
+        for (auto& request : requests) {
+            signer.SignRequest(request);
+        }
+    });
+    double batch = Measure("SignRequests(1000)", iterations, [&]() {
+        signer.SignRequests(requests);
+    });
+
+    printf("  saved %.1f ns/request (%.1f%%)\n", (oneByOne - batch) / batchSize, 100.0 * (oneByOne - batch) / oneByOne);
+}
+
+JDCLOUD_BENCHMARK(ParallelSignRequestsScaling) {
+    const size_t batchSize = 4096;
+    const size_t iterations = 5;
+    Credential credential("ak", "sk");
+    JdcloudSigner signer(credential, "vm", "cn-north-1");
+
+    // every 64th request carries a 256 KiB body, so the per-request cost is skewed.
+    vector<HttpRequest> requests(batchSize, BuildRequest());
+    for (size_t i = 0; i < batchSize; i += 64) {
+        requests[i].AddContentBody(make_shared<stringstream>(string(256 * 1024, 'x')));
+    }
+
+    size_t maxThreads = thread::hardware_concurrency();
+    if (maxThreads < 1) {
+        maxThreads = 1;
+    }
+
+    double single = 0;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        char label[64];
+        snprintf(label, sizeof(label), "%zu thread(s), %zu requests", threads, batchSize);
+        double elapsed = Measure(label, iterations, [&]() {
+            signer.SignRequests(requests, threads);
+        });
+        if (threads == 1) {
+            single = elapsed;
+        }
+        printf("  speedup x%.2f, efficiency %.0f%%\n", single / elapsed, 100.0 * single / elapsed / threads);
+    }
+}
+
+JDCLOUD_BENCHMARK(CanonicalRequestMaterializedVsStreamed) {
+    const size_t iterations = 20000;
+    CanonicalRequestBuilder builder;
+    Sha256 sha;
+    string query("?filters=");
+    query.append(8192, 'f');
+    vector<string> headerNames;
+    for (int i = 0; i < 40; ++i) {
+        headerNames.push_back("x-jdcloud-meta-" + to_string(10 + i));
+    }
+
+    auto build = [&](Sha256* digest, bool keep) {
+        builder.BeginCanonicalRequest("GET", "/v1/regions/cn-north-1/instances", query, digest, keep);
+        for (const auto& name : headerNames) {
+            builder.AppendHeader(name, "a reasonably long metadata value");
+        }
+        builder.EndCanonicalRequest("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    };
+
+    double materialized = Measure("build, then hash", iterations, [&]() {
+        build(nullptr, true);
+        StringView canonicalRequest = builder.GetCanonicalRequest();
+        sha.Calculate(canonicalRequest.data(), canonicalRequest.size());
+    });
+    double streamed = Measure("hash while building", iterations, [&]() {
+        build(&sha, false);
+        sha.Finish();
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", materialized - streamed, 100.0 * (materialized - streamed) / materialized);
+}
+
+JDCLOUD_BENCHMARK(DigestFreshContextVsPooled) {
+    const size_t iterations = 200000;
+    Sha256 sha;
+    string payload = "{\"instanceIds\":[\"i-abcdefgh\",\"i-ijklmnop\"],\"force\":true}";
+
+    // what Sha256::Calculate used to do: a context created and freed, and EVP_sha256() looked up, per call.
+    double fresh = Measure("EVP_MD_CTX per call", iterations, [&]() {
+        EVP_MD_CTX* ctx = EVP_MD_CTX_create();
+        EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr);
+        EVP_DigestUpdate(ctx, payload.data(), payload.size());
+        unsigned char hash[EVP_MAX_MD_SIZE];
+        unsigned int length = 0;
+        EVP_DigestFinal_ex(ctx, hash, &length);
+        EVP_MD_CTX_destroy(ctx);
+        HashingUtils::HexEncode(hash, length);
+    });
+    double pooled = Measure("pooled per thread", iterations, [&]() {
+        sha.Calculate(payload);
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", fresh - pooled, 100.0 * (fresh - pooled) / fresh);
+}
+
+JDCLOUD_BENCHMARK(HexEncodeKernels) {
+    const size_t iterations = 1000000;
+    unsigned char digest[32];
+    for (size_t i = 0; i < sizeof(digest); ++i) {
+        digest[i] = static_cast<unsigned char>(i * 73 + 5);
+    }
+    char text[64];
+
+    // the stringstream loop HexEncode used to be.
+    double stream = Measure("stringstream, 32 bytes", iterations / 10, [&]() {
+        stringstream ss;
+        for (size_t i = 0; i < sizeof(digest); ++i) {
+            ss << hex << setw(2) << setfill('0') << (unsigned int)digest[i];
+        }
+        ss.str();
+    });
+    double best = stream;
+    const HexKernel kernels[] = {HexKernel::Scalar, HexKernel::SSSE3, HexKernel::AVX2};
+    const char* names[] = {"scalar table, 32 bytes", "SSSE3, 32 bytes", "AVX2, 32 bytes"};
+    for (size_t k = 0; k < 3; ++k) {
+        if (!HashingUtils::IsHexKernelSupported(kernels[k])) {
+            printf("  %-48s unsupported on this CPU\n", names[k]);
+            continue;
+        }
+        best = Measure(names[k], iterations, [&]() {
+            HashingUtils::HexEncode(digest, sizeof(digest), text, kernels[k]);
+        });
+    }
+    unsigned char decoded[32];
+    Measure("decode, 64 characters", iterations, [&]() {
+        HashingUtils::HexDecode(text, sizeof(text), decoded);
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", stream - best, 100.0 * (stream - best) / stream);
+}
+
+JDCLOUD_BENCHMARK(NonceGeneratorPerCallVsPooled) {
+    const size_t iterations = 200000;
+    unsigned char nonce[NonceGenerator::NONCE_LENGTH];
+
+    double perCall = Measure("CSPRNG read per nonce", iterations, [&]() {
+        RAND_bytes(nonce, sizeof(nonce));
+        HashingUtils::HexEncode(nonce, sizeof(nonce));
+    });
+    double pooled = Measure("per-thread pooled", iterations, [&]() {
+        NonceGenerator::GenerateHex();
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", perCall - pooled, 100.0 * (perCall - pooled) / perCall);
+}
+
+JDCLOUD_BENCHMARK(SigningDatesStrftimeVsFormatter) {
+    const size_t iterations = 500000;
+    DateTime now(INT64_C(1234567890000));
+    SigningDates dates;
+
+    double strftimeBoth = Measure("ToGmtString x2", iterations, [&]() {
+        now.ToGmtString("%Y%m%dT%H%M%SZ");
+        now.ToGmtString("%Y%m%d");
+    });
+    int64_t millis = INT64_C(1234567890000);
+    Measure("ToSigningDates, new second every call", iterations, [&]() {
+        millis += 1000;
+        DateTime(millis).ToSigningDates(dates);
+    });
+    double cached = Measure("ToSigningDates, same second", iterations, [&]() {
+        now.ToSigningDates(dates);
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", strftimeBoth - cached, 100.0 * (strftimeBoth - cached) / strftimeBoth);
+}
+
+JDCLOUD_BENCHMARK(ClockSourcesUnderParallelSigning) {
+    const size_t perThread = 20000;
+    size_t threadCount = thread::hardware_concurrency();
+    threadCount = threadCount < 2 ? 2 : (threadCount > 8 ? 8 : threadCount);
+    const ClockSource sources[] = {ClockSource::Precise, ClockSource::Coarse, ClockSource::CachedSecond};
+    const char* names[] = {"precise", "coarse", "cached second"};
+
+    for (size_t s = 0; s < 3; ++s) {
+        Measure((string("DateTime::Now, ") + names[s]).c_str(), 2000000, [&]() {
+            DateTime::Now(sources[s]);
+        });
+    }
+
+    Credential credential("ak", "sk");
+    for (size_t s = 0; s < 3; ++s) {
+        JdcloudSigner signer(credential, "vm", "cn-north-1", sources[s]);
+        ostringstream label;
+        label << "SignRequest, " << threadCount << " threads, " << names[s];
+        // one iteration signs perThread requests on every thread, reported per request.
+        double perBatch = Measure(label.str().c_str(), 1, [&]() {
+            vector<thread> threads;
+            for (size_t t = 0; t < threadCount; ++t) {
+                threads.emplace_back([&]() {
+                    HttpRequest request = BuildRequest();
+                    for (size_t i = 0; i < perThread; ++i) {
+                        signer.SignRequest(request);
+                    }
+                });
+            }
+            for (auto& t : threads) {
+                t.join();
+            }
+        });
+        printf("  %-48s %12.1f ns/request\n", "  per request", perBatch / (perThread * threadCount));
+    }
+}
+
+JDCLOUD_BENCHMARK(SignRequestPlainVsPrepared) {
+    const size_t iterations = 100000;
+    Credential credential("ak", "sk");
+    JdcloudSigner signer(credential, "vm", "cn-north-1");
+    HttpRequest request = BuildRequest();
+    request.SetHeaderValue("x-jdcloud-meta-owner", "team  storage\n  ops");
+    request.SetHeaderValue("x-jdcloud-meta-tier", "gold");
+
+    double plain = Measure("SignRequest", iterations, [&]() {
+        signer.SignRequest(request);
+    });
+
+    PreparedRequest prepared = signer.PrepareRequest(request);
+    double fromPrepared = Measure("SignRequest with a prepared request", iterations, [&]() {
+        signer.SignRequest(request, prepared);
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", plain - fromPrepared, 100.0 * (plain - fromPrepared) / plain);
+}
+
+JDCLOUD_BENCHMARK(HeadersNodeMapVsFlatCollection) {
+    const size_t iterations = 200000;
+    HttpRequest request = BuildRequest();
+    request.SetHeaderValue(DATE_HEADER, "20090213T233130Z");
+    request.SetHeaderValue(NONCE_HEADER, "ebf8b26d-c3be-402f-9f10-f8b6573fd823");
+    request.SetHeaderValue("accept", "application/json");
+    request.SetHeaderValue("x-jdcloud-meta-tier", "gold");
+    map<string, string> nodeMap(request.GetHeaders().begin(), request.GetHeaders().end());
+    // summed so the walks are not optimized away.
+    volatile size_t total = 0;
+
+    // what signing used to do: copy the headers out, then build a second map from the copy.
+    double nodes = Measure("std::map copied and rebuilt", iterations, [&]() {
+        map<string, string> copy = nodeMap;
+        map<string, string> canonical;
+        for (const auto& header : copy) {
+            canonical[header.first] = header.second;
+        }
+        for (const auto& header : canonical) {
+            total += header.first.size() + header.second.size();
+        }
+    });
+    double flat = Measure("flat collection walked in place", iterations, [&]() {
+        for (const auto& header : request.GetHeaders()) {
+            total += header.first.size() + header.second.size();
+        }
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", nodes - flat, 100.0 * (nodes - flat) / nodes);
+}
+
+JDCLOUD_BENCHMARK(ResignCanonicalizeAllVsChangedOnly) {
+    const size_t iterations = 100000;
+    Credential credential("ak", "sk");
+    JdcloudSigner signer(credential, "vm", "cn-north-1");
+    HttpRequest request = BuildRequest();
+    request.SetHeaderValue("x-jdcloud-meta-owner", "team  storage\n  ops");
+    request.SetHeaderValue("x-jdcloud-meta-note", "retried   requests  keep\n their   headers");
+    request.SetHeaderValue("accept", "application/json");
+    signer.SignRequest(request);
+    volatile size_t total = 0;
+
+    // what every signature used to do for every header.
+    double all = Measure("canonicalize every header", iterations, [&]() {
+        for (const auto& header : request.GetHeaders()) {
+            total += HeaderValueEntry::CanonicalizeValue(header.second).size();
+        }
+    });
+    // a retry: only the date, nonce and authorization were set since the last signature.
+    double changed = Measure("canonicalize changed headers only", iterations, [&]() {
+        for (const auto& header : request.GetHeaders()) {
+            total += header.GetCanonicalValue().size();
+        }
+    });
+    printf("  saved %.1f ns/op (%.1f%%)\n", all - changed, 100.0 * (all - changed) / all);
+
+    Measure("SignRequest, same request signed again", iterations, [&]() {
+        signer.SignRequest(request);
+    });
+}
+
+JDCLOUD_BENCHMARK(HeaderValueCanonicalizeSplitVsSinglePass) {
+    const size_t iterations = 200000;
+    const vector<string> values = {
+        "application/json",
+        "team  storage\n  ops",
+        "JdcloudSdkCpp/1.0.2 vm/0.7.4 (Linux x86_64; gcc 8.3) with a long tail of product tokens",
+    };
+
+    // the split based canonicalization signing used before.
+    auto splitOnLines = [](const string& value) {
+        auto lines = StringUtils::SplitOnLine(StringUtils::Trim(value.c_str()));
+        string canonicalValue = lines.size() == 0 ? "" : lines[0];
+        for (size_t i = 1; i < lines.size(); ++i) {
+            canonicalValue += ",";
+            canonicalValue += StringUtils::Trim(lines[i].c_str());
+        }
+        canonicalValue.erase(unique(canonicalValue.begin(), canonicalValue.end(),
+                                    [](char lhs, char rhs) { return lhs == rhs && lhs == ' '; }),
+                             canonicalValue.end());
+        return canonicalValue;
+    };
+
+    for (const auto& value : values) {
+        string label = value.substr(0, 24);
+        replace(label.begin(), label.end(), '\n', ' ');
+        printf("  \"%s\"%s\n", label.c_str(), value.size() > label.size() ? "..." : "");
+
+        volatile size_t total = 0;
+        double split = Measure("trim, split on lines, unique", iterations, [&]() {
+            total += splitOnLines(value).size();
+        });
+        string canonicalValue;
+        double singlePass = Measure("single pass into a reused buffer", iterations, [&]() {
+            if (HeaderValueEntry::IsCanonicalValue(value)) {
+                total += value.size();
+            } else {
+                HeaderValueEntry::CanonicalizeValue(value, canonicalValue);
+                total += canonicalValue.size();
+            }
+        });
+        printf("  saved %.1f ns/op (%.1f%%)\n", split - singlePass, 100.0 * (split - singlePass) / split);
+    }
+}
+
+JDCLOUD_BENCHMARK(URIParseFivePassVsSinglePass) {
+    const size_t iterations = 500000;
+    const string text = "http://vm.cn-north-1.jdcloud-api.com:8000/v1/regions/cn-north-1/instances?pageNumber=2&pageSize=10";
+    volatile size_t total = 0;
+
+    // the parse URI used before: every part searched for "://" again and was copied out with substr.
+    double fivePass = Measure("five Extract* passes, substr copies", iterations, [&]() {
+        size_t separator = text.find("://");
+        string scheme = text.substr(0, separator);
+        size_t authorityStart = separator + 3;
+        size_t authorityEnd = min({text.find(':', authorityStart), text.find('/', authorityStart), text.find('?', authorityStart)});
+        string authority = text.substr(authorityStart, authorityEnd - authorityStart);
+        size_t portStart = text.find("://") + 3;
+        size_t colon = text.find(':', portStart);
+        string port;
+        for (size_t i = colon + 1; isdigit(text[i]); ++i) {
+            port += text[i];
+        }
+        size_t pathEnd = text.find('?');
+        string authorityAndPath = text.substr(text.find("://") + 3, pathEnd - authorityStart);
+        string path = authorityAndPath.substr(authorityAndPath.find('/'));
+        string queryString = text.substr(text.find('?'));
+        total += scheme.size() + authority.size() + atoi(port.c_str()) + path.size() + queryString.size();
+    });
+    double singlePass = Measure("URI(), single pass into one buffer", iterations, [&]() {
+        URI uri(text);
+        total += uri.GetAuthority().size() + uri.GetPath().size();
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", fivePass - singlePass, 100.0 * (fivePass - singlePass) / fivePass);
+}
+
+JDCLOUD_BENCHMARK(QueryStringCanonicalizeMapVsSort) {
+    for (size_t count : {10, 5000}) {
+        // shuffled so that sorting has work to do, every tenth key repeated.
+        vector<string> parameters;
+        for (size_t i = 0; i < count; ++i) {
+            parameters.push_back("filter." + to_string((i * 7919) % count / (i % 10 == 0 ? 2 : 1)) + "=value" + to_string(i));
+        }
+        string queryString;
+        for (const auto& parameter : parameters) {
+            queryString += (queryString.empty() ? "?" : "&") + parameter;
+        }
+        URI uri("http://vm.cn-north-1.jdcloud-api.com/v1/regions/cn-north-1/instances");
+        size_t iterations = count > 100 ? 200 : 100000;
+        printf("  %zu parameters\n", count);
+
+        // what canonicalizing did before: a std::map of copies, written out through a stringstream.
+        double map = Measure("std::map and stringstream", iterations, [&]() {
+            uri.SetQueryString(queryString);
+            stringstream canonical;
+            bool first = true;
+            for (const auto& parameter : uri.GetQueryStringParameters(false)) {
+                canonical << (first ? "?" : "&") << parameter.first << "=" << parameter.second;
+                first = false;
+            }
+            uri.SetQueryString(canonical.str());
+        });
+        double sorted = Measure("views sorted into a reused buffer", iterations, [&]() {
+            uri.SetQueryString(queryString);
+            uri.CanonicalizeQueryString();
+        });
+        printf("  saved %.1f ns/op (%.1f%%)\n", map - sorted, 100.0 * (map - sorted) / map);
+    }
+}
+
+JDCLOUD_BENCHMARK(URLEncodeStringstreamVsTable) {
+    const size_t iterations = 50000;
+    // an object storage style key: long, mostly safe, a few characters to escape.
+    string path = "/oss-bucket/backups/2018-11-02/";
+    for (int i = 0; i < 12; ++i) {
+        path += "database_shard-" + to_string(i) + "/snapshot.part" + to_string(i * 37) + " (copy)~v2/";
+    }
+    path += "final-manifest.json";
+    volatile size_t total = 0;
+
+    // the path encoder used before: split into a vector, every character through a stringstream.
+    double stream = Measure("split, stringstream per character", iterations, [&]() {
+        stringstream encoded;
+        for (const auto& segment : StringUtils::Split(path, '/')) {
+            stringstream escaped;
+            escaped.fill('0');
+            escaped << std::hex << std::uppercase;
+            for (char c : segment) {
+                if (c >= 0 && (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~')) {
+                    escaped << c;
+                } else {
+                    escaped << '%' << setw(2) << int((unsigned char)c) << setw(0);
+                }
+            }
+            encoded << '/' << escaped.str();
+        }
+        total += encoded.str().size();
+    });
+    string encoded;
+    double table = Measure("table and SIMD runs into a reused buffer", iterations, [&]() {
+        encoded.clear();
+        URI::URLEncodePath(path, encoded);
+        total += encoded.size();
+    });
+
+    printf("  %zu byte path, saved %.1f ns/op (%.1f%%)\n", path.size(), stream - table, 100.0 * (stream - table) / stream);
+}
+
+JDCLOUD_BENCHMARK(SetHeaderCopiesVsViews) {
+    const size_t iterations = 200000;
+    // what a client sets on every request before signing it again.
+    const pair<string, string> headers[] = {
+        {"Content-Type", "application/json"},
+        {"User-Agent", "JdcloudSdkCpp/1.2.0 vm/0.7.4"},
+        {"X-Jdcloud-Date", "20181102T031412Z"},
+        {"X-Jdcloud-Nonce", "ed76b4d4-8d4d-4c8d-8f0e-b2ff2e84d8e6"},
+        {"X-Jdcloud-Request-Id", "c2c6ba24-6cbb-4a95-8e67-2d93ac0e8bd9"},
+    };
+    volatile size_t total = 0;
+
+    // the copies SetHeaderValue used to make: a lowered name and a trimmed value, every time.
+    HeaderValueCollection copied;
+    double copies = Measure("ToLower and Trim copies", iterations, [&]() {
+        for (const auto& header : headers) {
+            copied.Set(StringUtils::ToLower(header.first.c_str()), StringUtils::Trim(header.second.c_str()));
+        }
+        total += copied.size();
+    });
+    HttpRequest request(URI("http://vm.jdcloud-api.com/v1/regions/cn-north-1/instances"), HttpMethod::HTTP_GET);
+    double views = Measure("lowered in place, trimmed view", iterations, [&]() {
+        for (const auto& header : headers) {
+            request.SetHeaderValue(header.first, header.second);
+        }
+        total += request.GetHeaders().size();
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", copies - views, 100.0 * (copies - views) / copies);
+}
+
+JDCLOUD_BENCHMARK(ResignBodyRehashVsCachedHash) {
+    const size_t iterations = 200;
+    Credential credential("ak", "sk");
+    JdcloudSigner signer(credential, "vm", "cn-north-1");
+    // a retried upload, smaller than the real ones so the bench stays quick.
+    auto body = make_shared<stringstream>(string(4 << 20, 'x'));
+
+    // setting the body again forgets the hash, which is what every re-sign paid before.
+    HttpRequest rehashed = BuildRequest();
+    double rehash = Measure("4 MB body hashed on every sign", iterations, [&]() {
+        rehashed.AddContentBody(body);
+        signer.SignRequest(rehashed);
+    });
+    HttpRequest cached = BuildRequest();
+    cached.AddContentBody(body);
+    double remembered = Measure("hash remembered for the body", iterations, [&]() {
+        signer.SignRequest(cached);
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", rehash - remembered, 100.0 * (rehash - remembered) / rehash);
+}
+
+JDCLOUD_BENCHMARK(SignBodySizesSignedVsUnsigned) {
+    const size_t iterations = 100;
+    Credential credential("ak", "sk");
+    JdcloudSigner signer(credential, "vm", "cn-north-1");
+
+    for (size_t size : {size_t(1) << 10, size_t(1) << 20, size_t(16) << 20}) {
+        auto body = make_shared<stringstream>(string(size, 'x'));
+        HttpRequest request = BuildRequest();
+        printf("  %zu KB body\n", size >> 10);
+        double hashed = Measure("  signed payload", iterations, [&]() {
+            request.SetPayloadSigning(PayloadSigning::SIGNED);
+            request.AddContentBody(body);
+            signer.SignRequest(request);
+        });
+        double marker = Measure("  UNSIGNED-PAYLOAD", iterations, [&]() {
+            request.SetPayloadSigning(PayloadSigning::UNSIGNED);
+            request.AddContentBody(body);
+            signer.SignRequest(request);
+        });
+        printf("  saved %.1f ns/op (%.1f%%)\n", hashed - marker, 100.0 * (hashed - marker) / hashed);
+    }
+}
+
+JDCLOUD_BENCHMARK(FirstByteHashFirstVsStreaming) {
+    const size_t iterations = 50;
+    Credential credential("ak", "sk");
+    JdcloudSigner signer(credential, "vm", "cn-north-1");
+    auto body = make_shared<stringstream>(string(16 << 20, 'x'));
+    vector<char> sent(64 * 1024);
+    volatile size_t total = 0;
+
+    // until the client has the first 64 KB to put on the wire.
+    HttpRequest hashFirst = BuildRequest();
+    double hashed = Measure("16 MB body hashed before sending", iterations, [&]() {
+        hashFirst.AddContentBody(body);
+        body->clear();
+        body->seekg(0);
+        signer.SignRequest(hashFirst);
+        hashFirst.GetContentBody()->read(sent.data(), sent.size());
+        total += hashFirst.GetContentBody()->gcount();
+    });
+    HttpRequest streaming = BuildRequest();
+    streaming.SetPayloadSigning(PayloadSigning::STREAMING);
+    double chunked = Measure("chunks signed while sending", iterations, [&]() {
+        streaming.AddContentBody(body);
+        body->clear();
+        body->seekg(0);
+        signer.SignRequest(streaming);
+        streaming.GetContentBody()->read(sent.data(), sent.size());
+        total += streaming.GetContentBody()->gcount();
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", hashed - chunked, 100.0 * (hashed - chunked) / hashed);
+}
+
+// a body that can only be read forward, like one piped from a decompressor.
+class ForwardOnlyStreambuf : public stringbuf {
+public:
+    explicit ForwardOnlyStreambuf(const string& data) : stringbuf(data) {}
+
+protected:
+    pos_type seekoff(off_type, ios_base::seekdir, ios_base::openmode) override { return pos_type(off_type(-1)); }
+    pos_type seekpos(pos_type, ios_base::openmode) override { return pos_type(off_type(-1)); }
+};
+
+JDCLOUD_BENCHMARK(ForwardOnlyBodyBufferedVsSpooled) {
+    const size_t iterations = 50;
+    Credential credential("ak", "sk");
+    JdcloudSigner signer(credential, "vm", "cn-north-1");
+    const string payload(1 << 20, 'x');
+    vector<char> sent(64 * 1024);
+    volatile size_t total = 0;
+    auto send = [&](iostream& body) {
+        while (body.read(sent.data(), sent.size()) || body.gcount() > 0) {
+            total += body.gcount();
+        }
+    };
+
+    // what a caller had to do before: read the whole body into a seekable stream first.
+    HttpRequest buffered = BuildRequest();
+    double copied = Measure("1 MB copied to a stringstream, hashed, sent", iterations, [&]() {
+        ForwardOnlyStreambuf source(payload);
+        iostream pipe(&source);
+        auto body = make_shared<stringstream>();
+        *body << pipe.rdbuf();
+        buffered.AddContentBody(body);
+        signer.SignRequest(buffered);
+        send(*buffered.GetContentBody());
+    });
+    HttpRequest spooled = BuildRequest();
+    double spooling = Measure("spooled while hashed, sent from the spool", iterations, [&]() {
+        ForwardOnlyStreambuf source(payload);
+        spooled.AddContentBody(make_shared<iostream>(&source));
+        signer.SignRequest(spooled);
+        send(*spooled.GetContentBody());
+    });
+
+    printf("  saved %.1f ns/op (%.1f%%)\n", copied - spooling, 100.0 * (copied - spooling) / copied);
+}
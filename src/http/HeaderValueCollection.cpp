@@ -0,0 +1,242 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "jdcloud_signer/http/HeaderValueCollection.h"
+#include "jdcloud_signer/util/StringUtils.h"
+
+#include <algorithm>
+#include <iterator>
+
+#if defined(__SSE2__)
+#define JDCLOUD_SIGNER_SSE2_HEADER_SCAN
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace jdcloud_signer {
+
+const size_t HeaderValueCollection::INLINE_CAPACITY;
+
+HeaderValueEntry::HeaderValueEntry() :
+    m_valueIsCanonical(true)
+{
+}
+
+HeaderValueEntry::HeaderValueEntry(string&& name, string&& value) :
+    HeaderValuePair(move(name), move(value))
+{
+    UpdateCanonicalValue();
+}
+
+bool HeaderValueEntry::IsCanonicalValue(StringView value)
+{
+    size_t size = value.size();
+    if (size == 0)
+    {
+        return true;
+    }
+    if (StringUtils::IsSpace(value.front()) || StringUtils::IsSpace(value.back()))
+    {
+        return false;
+    }
+
+    const char* data = value.data();
+    size_t i = 0;
+#ifdef JDCLOUD_SIGNER_SSE2_HEADER_SCAN
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i nul = _mm_setzero_si128();
+    const __m128i space = _mm_set1_epi8(' ');
+    //16 bytes at a time, each compared with the byte after it for double spaces, so one byte past the block is read.
+    for (; i + 17 <= size; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i next = _mm_loadu_si128((const __m128i*)(data + i + 1));
+        __m128i change = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, newline), _mm_cmpeq_epi8(block, nul)),
+                                      _mm_and_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(next, space)));
+        if (_mm_movemask_epi8(change) != 0)
+        {
+            return false;
+        }
+    }
+#endif
+    for (; i < size; ++i)
+    {
+        char c = data[i];
+        if (c == '\n' || c == '\0' || (c == ' ' && i + 1 < size && data[i + 1] == ' '))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void HeaderValueEntry::CanonicalizeValue(StringView value, string& out)
+{
+    out.clear();
+    //the value is read as a C string, anything after a NUL is dropped.
+    value = StringUtils::TrimView(value.substr(0, value.find('\0')));
+    //joining the lines puts one comma where a newline was, so the result is never longer.
+    out.reserve(value.size());
+
+    //multiline gets converted to line1,line2,etc. Empty lines are dropped, the ones after the first are trimmed.
+    bool firstLine = true;
+    size_t lineBegin = 0;
+    while (lineBegin < value.size())
+    {
+        size_t lineEnd = value.find('\n', lineBegin);
+        if (lineEnd == StringView::npos)
+        {
+            lineEnd = value.size();
+        }
+        StringView line = value.substr(lineBegin, lineEnd - lineBegin);
+        lineBegin = lineEnd + 1;
+        if (line.empty())
+        {
+            continue;
+        }
+        if (!firstLine)
+        {
+            out.push_back(',');
+            line = StringUtils::TrimView(line);
+        }
+        firstLine = false;
+
+        //duplicate spaces need to be converted to one.
+        for (char c : line)
+        {
+            if (c != ' ' || out.empty() || out.back() != ' ')
+            {
+                out.push_back(c);
+            }
+        }
+    }
+}
+
+string HeaderValueEntry::CanonicalizeValue(const string& value)
+{
+    string canonicalValue;
+    CanonicalizeValue(value, canonicalValue);
+    return canonicalValue;
+}
+
+void HeaderValueEntry::UpdateCanonicalValue()
+{
+    m_valueIsCanonical = IsCanonicalValue(second);
+    if (!m_valueIsCanonical)
+    {
+        CanonicalizeValue(second, m_canonicalValue);
+    }
+}
+
+void HeaderValueEntry::SetValue(string&& value)
+{
+    if (value != second)
+    {
+        second = move(value);
+        UpdateCanonicalValue();
+    }
+}
+
+void HeaderValueEntry::SetValue(StringView value)
+{
+    if (value != second)
+    {
+        second.assign(value.data(), value.size());
+        UpdateCanonicalValue();
+    }
+}
+
+HeaderValueCollection::HeaderValueCollection() :
+    m_size(0)
+{
+}
+
+size_t HeaderValueCollection::LowerBound(StringView name) const
+{
+    return lower_bound(begin(), end(), name,
+                       [](const HeaderValueEntry& header, StringView key) { return StringView(header.first) < key; })
+           - begin();
+}
+
+HeaderValueCollection::const_iterator HeaderValueCollection::find(StringView name) const
+{
+    const_iterator header = begin() + LowerBound(name);
+    return header != end() && StringView(header->first) == name ? header : end();
+}
+
+void HeaderValueCollection::Set(string&& name, StringView value)
+{
+    size_t position = LowerBound(name);
+    if (position < size() && Data()[position].first == name)
+    {
+        Data()[position].SetValue(value);
+        return;
+    }
+
+    if (!m_overflow.empty())
+    {
+        m_overflow.emplace(m_overflow.begin() + position, move(name), value.ToString());
+        return;
+    }
+
+    if (m_size == INLINE_CAPACITY)
+    {
+        //out of room, everything moves to the heap.
+        m_overflow.reserve(INLINE_CAPACITY * 2);
+        m_overflow.insert(m_overflow.end(), make_move_iterator(m_inline), make_move_iterator(m_inline + position));
+        m_overflow.emplace_back(move(name), value.ToString());
+        m_overflow.insert(m_overflow.end(), make_move_iterator(m_inline + position),
+                          make_move_iterator(m_inline + m_size));
+        m_size = 0;
+        return;
+    }
+
+    move_backward(m_inline + position, m_inline + m_size, m_inline + m_size + 1);
+    m_inline[position] = HeaderValueEntry(move(name), value.ToString());
+    ++m_size;
+}
+
+bool HeaderValueCollection::erase(StringView name)
+{
+    size_t position = LowerBound(name);
+    if (position == size() || StringView(Data()[position].first) != name)
+    {
+        return false;
+    }
+
+    if (!m_overflow.empty())
+    {
+        m_overflow.erase(m_overflow.begin() + position);
+        return true;
+    }
+
+    move(m_inline + position + 1, m_inline + m_size, m_inline + position);
+    --m_size;
+    m_inline[m_size] = HeaderValueEntry();
+    return true;
+}
+
+void HeaderValueCollection::clear()
+{
+    for (size_t i = 0; i < m_size; ++i)
+    {
+        m_inline[i] = HeaderValueEntry();
+    }
+    m_size = 0;
+    m_overflow.clear();
+}
+
+}
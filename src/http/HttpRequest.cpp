@@ -30,6 +30,10 @@ const char* AUTHORIZATION_HEADER = "authorization";
 const char* CONTENT_TYPE_HEADER = "content-type";
 const char* USER_AGENT_HEADER = "user-agent";
 const char* HOST_HEADER = "host";
+const char* CONTENT_SHA256_HEADER = "x-jdcloud-content-sha256";
+const char* CONTENT_LENGTH_HEADER = "content-length";
+const char* CONTENT_ENCODING_HEADER = "content-encoding";
+const char* DECODED_CONTENT_LENGTH_HEADER = "x-jdcloud-decoded-content-length";
 const string HttpRequest::m_emptyHeader = "";
 
 static bool IsDefaultPort(const URI& uri)
@@ -48,11 +52,14 @@ static bool IsDefaultPort(const URI& uri)
 HttpRequest::HttpRequest(const URI& uri, HttpMethod method) :
     m_uri(uri),
     m_method(method),
-    bodyStream(nullptr)
+    bodyStream(nullptr),
+    m_bodyGeneration(0),
+    m_payloadHashGeneration(0),
+    m_payloadSigning(PayloadSigning::SIGNED)
 {
     if(IsDefaultPort(uri))
     {
-        SetHeaderValue(HOST_HEADER, uri.GetAuthority());
+        SetHeaderValue(HOST_HEADER, uri.GetAuthority().ToString());
     }
     else
     {
@@ -62,18 +69,6 @@ HttpRequest::HttpRequest(const URI& uri, HttpMethod method) :
     }
 }
 
-HeaderValueCollection HttpRequest::GetHeaders() const
-{
-    HeaderValueCollection headers;
-
-    for (HeaderValueCollection::const_iterator iter = headerMap.begin(); iter != headerMap.end(); ++iter)
-    {
-        headers.emplace(HeaderValuePair(iter->first, iter->second));
-    }
-
-    return headers;
-}
-
 const string& HttpRequest::GetHeaderValue(const char* headerName) const
 {
     auto iter = headerMap.find(headerName);
@@ -87,22 +82,37 @@ const string& HttpRequest::GetHeaderValue(const char* headerName) const
 
 void HttpRequest::SetHeaderValue(const char* headerName, const string& headerValue)
 {
-    headerMap[StringUtils::ToLower(headerName)] = StringUtils::Trim(headerValue.c_str());
+    string name(headerName);
+    StringUtils::ToLowerInPlace(name);
+    //the value ends at its first NUL, as it always has.
+    headerMap.Set(move(name), StringUtils::TrimView(headerValue.c_str()));
 }
 
 void HttpRequest::SetHeaderValue(const string& headerName, const string& headerValue)
 {
-    headerMap[StringUtils::ToLower(headerName.c_str())] = StringUtils::Trim(headerValue.c_str());
+    SetHeaderValue(headerName.c_str(), headerValue);
+}
+
+void HttpRequest::SetPayloadHash(const string& payloadHash)
+{
+    //the canonical request wants lower case hex.
+    m_payloadHash.assign(payloadHash);
+    StringUtils::ToLowerInPlace(m_payloadHash);
+    m_payloadHashGeneration = m_bodyGeneration;
 }
 
 void HttpRequest::DeleteHeader(const char* headerName)
 {
-    headerMap.erase(StringUtils::ToLower(headerName));
+    string name(headerName);
+    StringUtils::ToLowerInPlace(name);
+    headerMap.erase(name);
 }
 
 bool HttpRequest::HasHeader(const char* headerName) const
 {
-    return headerMap.find(StringUtils::ToLower(headerName)) != headerMap.end();
+    string name(headerName);
+    StringUtils::ToLowerInPlace(name);
+    return headerMap.find(name) != headerMap.end();
 }
 
 int64_t HttpRequest::GetSize() const
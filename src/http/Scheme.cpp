@@ -39,16 +39,15 @@ namespace SchemeMapper
 
     Scheme FromString(const char* name)
     {
-        string trimmedString = StringUtils::Trim(name);
-        string loweredTrimmedString = StringUtils::ToLower(trimmedString.c_str());
+        StringView trimmed = StringUtils::TrimView(name);
 
-        if (loweredTrimmedString == "http")
+        if (StringUtils::CaselessEquals(trimmed, "http"))
         {
             return Scheme::HTTP;
         }
         //this branch is technically unneeded, but it is here so we don't have a subtle bug
         //creep in as we extend this enum.
-        else if (loweredTrimmedString == "https")
+        else if (StringUtils::CaselessEquals(trimmed, "https"))
         {
             return Scheme::HTTPS;
         }
@@ -20,7 +20,6 @@
 #include <cctype>
 #include <cassert>
 #include <algorithm>
-#include <iomanip>
 #include <vector>
 #include "jdcloud_signer/util/StringUtils.h"
 
@@ -30,16 +29,16 @@ namespace jdcloud_signer {
 
 const char* SEPARATOR = "://";
 
-URI::URI() : m_scheme(Scheme::HTTP), m_port(HTTP_DEFAULT_PORT)
+URI::URI() : m_scheme(Scheme::HTTP), m_port(HTTP_DEFAULT_PORT), m_pathBegin(0), m_queryBegin(0)
 {
 }
 
-URI::URI(const string& uri) : m_scheme(Scheme::HTTP), m_port(HTTP_DEFAULT_PORT)
+URI::URI(const string& uri) : m_scheme(Scheme::HTTP), m_port(HTTP_DEFAULT_PORT), m_pathBegin(0), m_queryBegin(0)
 {
     ParseURIParts(uri);
 }
 
-URI::URI(const char* uri) : m_scheme(Scheme::HTTP), m_port(HTTP_DEFAULT_PORT)
+URI::URI(const char* uri) : m_scheme(Scheme::HTTP), m_port(HTTP_DEFAULT_PORT), m_pathBegin(0), m_queryBegin(0)
 {
     ParseURIParts(uri);
 }
@@ -102,77 +101,109 @@ void URI::SetScheme(Scheme value)
     }
 }
 
-string URI::URLEncodePathRFC3986(const string& path)
+string URI::URLEncodePathRFC3986(StringView path)
+{
+    string encoded;
+    URLEncodePathRFC3986(path, encoded);
+    return encoded;
+}
+
+void URI::URLEncodePathRFC3986(StringView path, string& encoded)
 {
     if(path.empty())
     {
-        return path;
+        return;
     }
 
-    const vector<string> pathParts = StringUtils::Split(path, '/');
-    stringstream ss;
-    ss << std::hex << std::uppercase;
-
-    // escape characters appearing in a URL path according to RFC 3986
-    for (const auto& segment : pathParts)
+    // escape characters appearing in a URL path according to RFC 3986: the unreserved characters stay and so do
+    // the reserved ones a path may hold, $&,/:;=@ (URLSafeCharacters::Path).
+    // NOTE: this implementation does not accurately implement the RFC on purpose to accommodate for
+    // discrepancies in the implementations of URL encoding between services for legacy reasons.
+    // Empty segments are dropped.
+    encoded.reserve(encoded.size() + path.size() + 1);
+    size_t segmentBegin = 0;
+    while (segmentBegin < path.size())
     {
-        ss << '/';
-        for(unsigned char c : segment) // alnum results in UB if the value of c is not unsigned char & is not EOF
+        size_t segmentEnd = path.find('/', segmentBegin);
+        if (segmentEnd == StringView::npos)
         {
-            if(std::isalnum(c)) // §2.3 unreserved characters
-            {
-                ss << c;
-                continue;
-            }
-            switch(c)
-            {
-                // §2.3 unreserved characters
-                case '-': case '_': case '.': case '~':
-                // The path section of the URL allow reserved characters to appear unescaped
-                // RFC 3986 §2.2 Reserved characters
-                // NOTE: this implementation does not accurately implement the RFC on purpose to accommodate for
-                // discrepancies in the implementations of URL encoding between services for legacy reasons.
-                case '$': case '&': case ',': case '/':
-                case ':': case ';': case '=': case '@':
-                    ss << c;
-                    break;
-                default:
-                    ss << '%' << std::setw(2) << (int)((unsigned char)c) << std::setw(0);
-            }
+            segmentEnd = path.size();
+        }
+        if (segmentEnd > segmentBegin)
+        {
+            encoded.push_back('/');
+            StringUtils::URLEncode(path.substr(segmentBegin, segmentEnd - segmentBegin), encoded,
+                                   URLSafeCharacters::Path);
         }
+        segmentBegin = segmentEnd + 1;
     }
 
     //if the last character was also a slash, then add that back here.
     if (path.back() == '/')
     {
-        ss << '/';
+        encoded.push_back('/');
     }
-
-    return ss.str();
 }
 
-string URI::URLEncodePath(const string& path)
+string URI::URLEncodePath(StringView path)
 {
-    vector<string> pathParts = StringUtils::Split(path, '/');
-    stringstream ss;
+    string encoded;
+    URLEncodePath(path, encoded);
+    return encoded;
+}
 
-    for (vector<string>::iterator iter = pathParts.begin(); iter != pathParts.end(); ++iter)
-    {
-        ss << '/' << StringUtils::URLEncode(iter->c_str());
+void URI::URLEncodePath(StringView path, string& encoded)
+{
+    //the path is encoded segment by segment in place, empty segments are dropped. Paths are mostly safe
+    //characters, so room for the path as it is usually does.
+    encoded.reserve(encoded.size() + path.size() + 1);
+    size_t segmentBegin = 0;
+    while (segmentBegin < path.size())
+    {
+        size_t segmentEnd = path.find('/', segmentBegin);
+        if (segmentEnd == StringView::npos)
+        {
+            segmentEnd = path.size();
+        }
+        if (segmentEnd > segmentBegin)
+        {
+            //each segment used to be encoded as a C string, so it still ends at a NUL.
+            StringView segment = path.substr(segmentBegin, segmentEnd - segmentBegin);
+            encoded.push_back('/');
+            StringUtils::URLEncode(segment.substr(0, segment.find('\0')), encoded);
+        }
+        segmentBegin = segmentEnd + 1;
     }
 
     //if the last character was also a slash, then add that back here.
-    if (path[path.length() - 1] == '/')
+    if (!path.empty() && path.back() == '/')
     {
-        ss << '/';
+        encoded.push_back('/');
     }
+}
 
-    return ss.str();
+void URI::SetAuthority(const string& value)
+{
+    SetParts(value, GetPath(), GetQueryString());
 }
 
 void URI::SetPath(const string& value)
 {
-    m_path = value;
+    SetParts(GetAuthority(), value, GetQueryString());
+}
+
+void URI::SetParts(StringView authority, StringView path, StringView queryString)
+{
+    //the parts may point into the current buffer, so the new one is built on the side.
+    string buffer;
+    buffer.reserve(authority.size() + path.size() + queryString.size());
+    buffer.append(authority.data(), authority.size());
+    buffer.append(path.data(), path.size());
+    buffer.append(queryString.data(), queryString.size());
+
+    m_buffer.swap(buffer);
+    m_pathBegin = authority.size();
+    m_queryBegin = m_pathBegin + path.size();
 }
 
 //ugh, this isn't even part of the canonicalization spec. It is part of how our services have implemented their signers though....
@@ -194,7 +225,7 @@ void InsertValueOrderedParameter(QueryStringParameterCollection& queryParams, co
 
 QueryStringParameterCollection URI::GetQueryStringParameters(bool decode) const
 {
-    string queryString = GetQueryString();
+    StringView queryString = GetQueryString();
 
     QueryStringParameterCollection parameterCollection;
 
@@ -208,32 +239,21 @@ QueryStringParameterCollection URI::GetQueryStringParameters(bool decode) const
         {
             //find next key/value pair
             locationOfNextDelimiter = queryString.find('&', currentPos);
-
-            string keyValuePair;
-
-            //if this isn't the last parameter
-            if (locationOfNextDelimiter != string::npos)
-            {
-                keyValuePair = queryString.substr(currentPos, locationOfNextDelimiter - currentPos);
-            }
-            //if it is the last parameter
-            else
-            {
-                keyValuePair = queryString.substr(currentPos);
-            }
+            StringView keyValuePair = queryString.substr(currentPos, locationOfNextDelimiter - currentPos);
 
             //split on =
             size_t locationOfEquals = keyValuePair.find('=');
-            string key = keyValuePair.substr(0, locationOfEquals);
-            string value = keyValuePair.substr(locationOfEquals + 1);
+            StringView key = keyValuePair.substr(0, locationOfEquals);
+            StringView value = keyValuePair.substr(locationOfEquals + 1);
 
             if(decode)
             {
-                InsertValueOrderedParameter(parameterCollection, StringUtils::URLDecode(key.c_str()), StringUtils::URLDecode(value.c_str()));
+                InsertValueOrderedParameter(parameterCollection, StringUtils::URLDecode(key.ToString().c_str()),
+                                            StringUtils::URLDecode(value.ToString().c_str()));
             }
             else
             {
-                InsertValueOrderedParameter(parameterCollection, key, value);
+                InsertValueOrderedParameter(parameterCollection, key.ToString(), value.ToString());
             }
 
             currentPos += keyValuePair.size() + 1;
@@ -243,48 +263,76 @@ QueryStringParameterCollection URI::GetQueryStringParameters(bool decode) const
     return parameterCollection;
 }
 
+typedef pair<StringView, StringView> QueryStringParameter;
+
 void URI::CanonicalizeQueryString()
 {
-    QueryStringParameterCollection sortedParameters = GetQueryStringParameters(false);
-    stringstream queryStringStream;
-
-    bool first = true;
-
-    if(sortedParameters.size() > 0)
+    StringView queryString = GetQueryString();
+    if (queryString.find('=') == StringView::npos)
     {
-        queryStringStream << "?";
+        return;
     }
 
-    if(m_queryString.find("=") != std::string::npos)
+    //the parameters point into the buffer, the canonical string is written on the side and copied back.
+    static thread_local vector<QueryStringParameter> parameters;
+    static thread_local string canonicalQueryString;
+    parameters.clear();
+
+    size_t currentPos = 1;
+    while (currentPos < queryString.size())
     {
-        for (QueryStringParameterCollection::iterator iter = sortedParameters.begin();
-            iter != sortedParameters.end(); ++iter)
+        size_t locationOfNextDelimiter = queryString.find('&', currentPos);
+        if (locationOfNextDelimiter == StringView::npos)
         {
-            if (!first)
-            {
-                queryStringStream << "&";
-            }
-
-            first = false;
-            queryStringStream << iter->first.c_str() << "=" << iter->second.c_str();
+            locationOfNextDelimiter = queryString.size();
         }
+        StringView keyValuePair = queryString.substr(currentPos, locationOfNextDelimiter - currentPos);
+
+        //a parameter without '=' has always been signed with the whole parameter as its value.
+        size_t locationOfEquals = keyValuePair.find('=');
+        StringView key = keyValuePair.substr(0, locationOfEquals);
+        StringView value = locationOfEquals == StringView::npos ? keyValuePair : keyValuePair.substr(locationOfEquals + 1);
+        parameters.emplace_back(key, value);
+
+        currentPos = locationOfNextDelimiter + 1;
+    }
+
+    //repeated keys are all kept, ordered by their values. Parameters that compare equal are identical, so the
+    //order needs no stable_sort, which would allocate a buffer on every call.
+    sort(parameters.begin(), parameters.end(),
+                [](const QueryStringParameter& lhs, const QueryStringParameter& rhs) {
+                    int keyOrder = lhs.first.compare(rhs.first);
+                    return keyOrder != 0 ? keyOrder < 0 : lhs.second < rhs.second;
+                });
 
-        m_queryString = queryStringStream.str();
+    canonicalQueryString.clear();
+    canonicalQueryString.reserve(queryString.size() + parameters.size());
+    for (const auto& parameter : parameters)
+    {
+        canonicalQueryString.push_back(canonicalQueryString.empty() ? '?' : '&');
+        canonicalQueryString.append(parameter.first.data(), parameter.first.size());
+        canonicalQueryString.push_back('=');
+        canonicalQueryString.append(parameter.second.data(), parameter.second.size());
     }
+
+    m_buffer.resize(m_queryBegin);
+    m_buffer.append(canonicalQueryString);
 }
 
 void URI::AddQueryStringParameter(const char* key, const string& value)
 {
-    if (m_queryString.size() <= 0)
+    if (GetQueryString().empty())
     {
-        m_queryString.append("?");
+        m_buffer.append("?");
     }
     else
     {
-        m_queryString.append("&");
+        m_buffer.append("&");
     }
 
-    m_queryString.append(StringUtils::URLEncode(key) + "=" + StringUtils::URLEncode(value.c_str()));
+    StringUtils::URLEncode(key, m_buffer);
+    m_buffer.push_back('=');
+    StringUtils::URLEncode(value.c_str(), m_buffer);
 }
 
 void URI::AddQueryStringParameter(const map<string, string>& queryStringPairs)
@@ -297,26 +345,24 @@ void URI::AddQueryStringParameter(const map<string, string>& queryStringPairs)
 
 void URI::SetQueryString(const string& str)
 {
-    m_queryString = "";
+    //the query string is last in the buffer, so it is replaced in place.
+    m_buffer.resize(m_queryBegin);
 
     if (str.empty()) return;
 
     if (str.front() != '?')
     {
-        m_queryString.append("?").append(str);
-    }
-    else
-    {
-        m_queryString = str;
+        m_buffer.append("?");
     }
+    m_buffer.append(str);
 }
 
 string URI::GetURIString(bool includeQueryString) const
 {
-    assert(m_authority.size() > 0);
+    assert(GetAuthority().size() > 0);
 
     stringstream ss;
-    ss << SchemeMapper::ToString(m_scheme) << SEPARATOR << m_authority;
+    ss << SchemeMapper::ToString(m_scheme) << SEPARATOR << GetAuthority();
 
     if (m_scheme == Scheme::HTTP && m_port != HTTP_DEFAULT_PORT)
     {
@@ -327,166 +373,105 @@ string URI::GetURIString(bool includeQueryString) const
         ss << ":" << m_port;
     }
 
-    if(m_path != "/")
+    if(GetPath() != "/")
     {
-        ss << URLEncodePathRFC3986(m_path);
+        ss << URLEncodePathRFC3986(GetPath());
     }
 
     if(includeQueryString)
     {
-        ss << m_queryString;
+        ss << GetQueryString();
     }
 
     return ss.str();
 }
 
-void URI::ParseURIParts(const string& uri)
-{
-    ExtractAndSetScheme(uri);
-    ExtractAndSetAuthority(uri);
-    ExtractAndSetPort(uri);
-    ExtractAndSetPath(uri);
-    ExtractAndSetQueryString(uri);
-}
-
-void URI::ExtractAndSetScheme(const string& uri)
+static Scheme ParseScheme(StringView scheme)
 {
-    size_t posOfSeparator = uri.find(SEPARATOR);
-
-    if (posOfSeparator != string::npos)
+    if (scheme == "http")
     {
-        string schemePortion = uri.substr(0, posOfSeparator);
-        SetScheme(SchemeMapper::FromString(schemePortion.c_str()));
+        return Scheme::HTTP;
     }
-    else
+    if (scheme == "https")
     {
-        SetScheme(Scheme::HTTP);
+        return Scheme::HTTPS;
     }
+    //what SchemeMapper::FromString would say, without copying the scheme.
+    return StringUtils::CaselessEquals(StringUtils::TrimView(scheme), "http") ? Scheme::HTTP : Scheme::HTTPS;
 }
 
-void URI::ExtractAndSetAuthority(const string& uri)
+void URI::ParseURIParts(StringView uri)
 {
-    size_t authorityStart = uri.find(SEPARATOR);
-
-    if (authorityStart == string::npos)
-    {
-        authorityStart = 0;
-    }
-    else
-    {
-        authorityStart += 3;
-    }
-
-    size_t posOfEndOfAuthorityPort = uri.find(':', authorityStart);
-    size_t posOfEndOfAuthoritySlash = uri.find('/', authorityStart);
-    size_t posOfEndOfAuthorityQuery = uri.find('?', authorityStart);
-    size_t posEndOfAuthority = (std::min)({posOfEndOfAuthorityPort, posOfEndOfAuthoritySlash, posOfEndOfAuthorityQuery});
-    if (posEndOfAuthority == string::npos)
+    size_t authorityStart = 0;
+    size_t posOfSeparator = uri.find(':');
+    while (posOfSeparator != StringView::npos && uri.substr(posOfSeparator, 3) != SEPARATOR)
     {
-        posEndOfAuthority = uri.length();
+        posOfSeparator = uri.find(':', posOfSeparator + 1);
     }
 
-    SetAuthority(uri.substr(authorityStart, posEndOfAuthority - authorityStart));
-}
-
-void URI::ExtractAndSetPort(const string& uri)
-{
-    size_t authorityStart = uri.find(SEPARATOR);
-
-    if(authorityStart == string::npos)
+    if (posOfSeparator != StringView::npos)
     {
-        authorityStart = 0;
+        SetScheme(ParseScheme(uri.substr(0, posOfSeparator)));
+        authorityStart = posOfSeparator + 3;
     }
     else
     {
-        authorityStart += 3;
+        SetScheme(Scheme::HTTP);
     }
 
-    size_t positionOfPortDelimiter = uri.find(':', authorityStart);
-
-    bool hasPort = positionOfPortDelimiter != string::npos;
-
-    if ((uri.find('/', authorityStart) < positionOfPortDelimiter) || (uri.find('?', authorityStart) < positionOfPortDelimiter))
+    //one pass over the rest: the authority ends at ':', '/' or '?', the port digits follow a ':' that comes
+    //before any '/' or '?', the path runs from the first '/' to the '?' and the query string to the end.
+    size_t end = uri.size();
+    size_t i = authorityStart;
+    while (i < end && uri[i] != ':' && uri[i] != '/' && uri[i] != '?')
     {
-        hasPort = false;
+        ++i;
     }
+    StringView authority = uri.substr(authorityStart, i - authorityStart);
 
-    if (hasPort)
+    if (i < end && uri[i] == ':')
     {
-        string strPort;
-
-        size_t i = positionOfPortDelimiter + 1;
-        char currentDigit = uri[i];
-
-        while (std::isdigit(currentDigit))
+        uint32_t port = 0;
+        for (++i; i < end && uri[i] >= '0' && uri[i] <= '9'; ++i)
         {
-            strPort += currentDigit;
-            currentDigit = uri[++i];
+            port = port * 10 + (uri[i] - '0');
         }
+        SetPort(static_cast<uint16_t>(port));
 
-        SetPort(static_cast<uint16_t>(atoi(strPort.c_str())));
-    }
-}
-
-void URI::ExtractAndSetPath(const string& uri)
-{
-    size_t authorityStart = uri.find(SEPARATOR);
-
-    if (authorityStart == string::npos)
-    {
-        authorityStart = 0;
-    }
-    else
-    {
-        authorityStart += 3;
-    }
-
-    size_t pathEnd = uri.find('?');
-
-    if (pathEnd == string::npos)
-    {
-        pathEnd = uri.length();
+        //whatever follows the digits, up to the path or the query string, was ignored before as well.
+        while (i < end && uri[i] != '/' && uri[i] != '?')
+        {
+            ++i;
+        }
     }
 
-    string authorityAndPath = uri.substr(authorityStart, pathEnd - authorityStart);
-
-    size_t pathStart = authorityAndPath.find('/');
-
-    if (pathStart != string::npos)
-    {
-        SetPath(authorityAndPath.substr(pathStart, pathEnd - pathStart));
-    }
-    else
+    size_t queryStart = uri.find('?', i);
+    if (queryStart == StringView::npos)
     {
-        SetPath("/");
+        queryStart = end;
     }
-}
-
-void URI::ExtractAndSetQueryString(const string& uri)
-{
-    size_t queryStart = uri.find('?');
 
-    if (queryStart != string::npos)
-    {
-        m_queryString = uri.substr(queryStart);
-    }
+    StringView path = i < queryStart ? uri.substr(i, queryStart - i) : StringView("/");
+    SetParts(authority, path, uri.substr(queryStart));
 }
 
 string URI::GetFormParameters() const
 {
-    if(m_queryString.length() == 0)
+    StringView queryString = GetQueryString();
+    if(queryString.length() == 0)
     {
         return "";
     }
     else
     {
-        return m_queryString.substr(1);
+        return queryString.substr(1).ToString();
     }
 }
 
 bool URI::CompareURIParts(const URI& other) const
 {
-    return m_scheme == other.m_scheme && m_authority == other.m_authority && m_path == other.m_path && m_queryString == other.m_queryString;
+    return m_scheme == other.m_scheme && GetAuthority() == other.GetAuthority() && GetPath() == other.GetPath()
+        && GetQueryString() == other.GetQueryString();
 }
 
 }
@@ -0,0 +1,131 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "jdcloud_signer/CanonicalRequestBuilder.h"
+
+using namespace jdcloud_signer;
+using namespace std;
+
+// Counts the operator new calls made by this binary, the signer library included. Atomic, as other tests allocate
+// from several threads; JdcloudSignerImplTest reads it too.
+atomic<size_t> allocationCount(0);
+
+void* operator new(size_t size) {
+    ++allocationCount;
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+static void BuildSignature(CanonicalRequestBuilder& builder) {
+    builder.BeginCanonicalRequest("GET", "/v1/regions/cn-north-1/instances", "?pageNumber=2&pageSize=10");
+    builder.AppendHeader("content-type", "application/json");
+    builder.AppendHeader("host", "vm.cn-north-1.jdcloud-api.com");
+    builder.AppendHeader("x-jdcloud-date", "20090213T233130Z");
+    builder.AppendHeader("x-jdcloud-nonce", "ed1d94ecab4a4bbd9ea6d5f35b0b6ccd");
+    builder.EndCanonicalRequest("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    builder.BuildStringToSign("JDCLOUD2-HMAC-SHA256", "20090213T233130Z", "20090213/cn-north-1/vm/jdcloud2_request",
+                              "7c5a5ab79b9ae5b6bcd2b6dcbdb7b29f0b0c43ecbbf2b1f4d0b3c8ab6dd1b4d2");
+    builder.BuildAuthorization("JDCLOUD2-HMAC-SHA256", "ak", "20090213/cn-north-1/vm/jdcloud2_request",
+                               "43a76892222031f847c00c56cac8d4d2dc179a4e75a37868d09a5300435f4054");
+}
+
+TEST(CanonicalRequestBuilder, Build) {
+    CanonicalRequestBuilder builder;
+    BuildSignature(builder);
+
+    EXPECT_EQ(builder.GetCanonicalRequest().ToString(),
+              "GET\n/v1/regions/cn-north-1/instances\npageNumber=2&pageSize=10\n"
+              "content-type:application/json\nhost:vm.cn-north-1.jdcloud-api.com\n"
+              "x-jdcloud-date:20090213T233130Z\nx-jdcloud-nonce:ed1d94ecab4a4bbd9ea6d5f35b0b6ccd\n\n"
+              "content-type;host;x-jdcloud-date;x-jdcloud-nonce\n"
+              "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(builder.GetSignedHeaders().ToString(), "content-type;host;x-jdcloud-date;x-jdcloud-nonce");
+    EXPECT_EQ(builder.GetStringToSign().ToString(),
+              "JDCLOUD2-HMAC-SHA256\n20090213T233130Z\n20090213/cn-north-1/vm/jdcloud2_request\n"
+              "7c5a5ab79b9ae5b6bcd2b6dcbdb7b29f0b0c43ecbbf2b1f4d0b3c8ab6dd1b4d2");
+    EXPECT_EQ(builder.GetAuthorization().ToString(),
+              "JDCLOUD2-HMAC-SHA256 Credential=ak/20090213/cn-north-1/vm/jdcloud2_request, "
+              "SignedHeaders=content-type;host;x-jdcloud-date;x-jdcloud-nonce, "
+              "Signature=43a76892222031f847c00c56cac8d4d2dc179a4e75a37868d09a5300435f4054");
+}
+
+TEST(CanonicalRequestBuilder, QueryWithoutValue) {
+    CanonicalRequestBuilder builder;
+    builder.BeginCanonicalRequest("GET", "/", "?acl");
+    builder.EndCanonicalRequest("hash");
+    EXPECT_EQ(builder.GetCanonicalRequest().ToString(), "GET\n/\nacl=\n\n\nhash");
+
+    builder.BeginCanonicalRequest("GET", "/", "");
+    builder.EndCanonicalRequest("hash");
+    EXPECT_EQ(builder.GetCanonicalRequest().ToString(), "GET\n/\n\n\n\nhash");
+}
+
+TEST(CanonicalRequestBuilder, NoAllocationInSteadyState) {
+    CanonicalRequestBuilder builder;
+    BuildSignature(builder);
+
+    size_t before = allocationCount;
+    for (int i = 0; i < 100; ++i) {
+        BuildSignature(builder);
+    }
+    EXPECT_EQ(allocationCount - before, 0u);
+}
+
+static void BuildLargeRequest(CanonicalRequestBuilder& builder, Sha256* digest, bool keepCanonicalRequest) {
+    // a query and a header value each larger than the staging area, plus enough headers to flush it several times.
+    string query("?key=");
+    query.append(CanonicalRequestBuilder::STAGING_CAPACITY + 100, 'q');
+    builder.BeginCanonicalRequest("PUT", "/v1/buckets/b/objects/o", query, digest, keepCanonicalRequest);
+    builder.AppendHeader("a-large", string(CanonicalRequestBuilder::STAGING_CAPACITY * 2, 'v'));
+    for (int i = 0; i < 200; ++i) {
+        builder.AppendHeader("x-jdcloud-meta-" + to_string(1000 + i), "some metadata value " + to_string(i));
+    }
+    builder.EndCanonicalRequest("UNSIGNED-PAYLOAD");
+}
+
+TEST(CanonicalRequestBuilder, StreamedDigestMatchesMaterialized) {
+    CanonicalRequestBuilder builder;
+    Sha256 sha;
+    Sha256 digest;
+
+    BuildSignature(builder);
+    Sha256Digest expectedHash = sha.Calculate(builder.GetCanonicalRequest().ToString()).GetResult();
+    string expectedSignedHeaders = builder.GetSignedHeaders().ToString();
+
+    builder.BeginCanonicalRequest("GET", "/v1/regions/cn-north-1/instances", "?pageNumber=2&pageSize=10", &digest, false);
+    builder.AppendHeader("content-type", "application/json");
+    builder.AppendHeader("host", "vm.cn-north-1.jdcloud-api.com");
+    builder.AppendHeader("x-jdcloud-date", "20090213T233130Z");
+    builder.AppendHeader("x-jdcloud-nonce", "ed1d94ecab4a4bbd9ea6d5f35b0b6ccd");
+    builder.EndCanonicalRequest("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(digest.Finish().GetResult(), expectedHash);
+    EXPECT_TRUE(builder.GetCanonicalRequest().empty());
+    EXPECT_EQ(builder.GetSignedHeaders().ToString(), expectedSignedHeaders);
+
+    builder.BuildStringToSign("JDCLOUD2-HMAC-SHA256", "20090213T233130Z", "scope", Sha256HexDigest(expectedHash));
+    builder.BuildAuthorization("JDCLOUD2-HMAC-SHA256", "ak", "scope", "signature");
+    EXPECT_EQ(builder.GetAuthorization().ToString(),
+              "JDCLOUD2-HMAC-SHA256 Credential=ak/scope, SignedHeaders=" + expectedSignedHeaders + ", Signature=signature");
+
+    BuildLargeRequest(builder, nullptr, true);
+    expectedHash = sha.Calculate(builder.GetCanonicalRequest().ToString()).GetResult();
+    expectedSignedHeaders = builder.GetSignedHeaders().ToString();
+
+    BuildLargeRequest(builder, &digest, false);
+    EXPECT_EQ(digest.Finish().GetResult(), expectedHash);
+    EXPECT_EQ(builder.GetSignedHeaders().ToString(), expectedSignedHeaders);
+
+    // keeping the canonical request still feeds the digest.
+    BuildLargeRequest(builder, &digest, true);
+    EXPECT_EQ(digest.Finish().GetResult(), expectedHash);
+    EXPECT_EQ(sha.Calculate(builder.GetCanonicalRequest().ToString()).GetResult(), expectedHash);
+}
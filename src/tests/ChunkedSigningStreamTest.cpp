@@ -0,0 +1,102 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+#include "jdcloud_signer/ChunkedSigningStream.h"
+#include "jdcloud_signer/util/crypto/Sha256HMAC.h"
+
+using namespace jdcloud_signer;
+using namespace std;
+
+static const char* DATE = "20090213T233130Z";
+static const char* SCOPE = "20090213/cn-north-1/vm/jdcloud2_request";
+
+static string ReadAll(istream& stream) {
+    stringstream read;
+    read << stream.rdbuf();
+    return read.str();
+}
+
+// decodes the framed body, checking every chunk signature against one computed the long way.
+static string Decode(const string& encoded, const string& key, const string& seed, size_t chunkSize) {
+    Sha256 sha256;
+    Sha256HMAC hmac;
+    string payload, previous = seed;
+    size_t position = 0;
+    for (;;) {
+        size_t headerEnd = encoded.find("\r\n", position);
+        EXPECT_NE(headerEnd, string::npos);
+        string header = encoded.substr(position, headerEnd - position);
+        size_t separator = header.find(";chunk-signature=");
+        EXPECT_NE(separator, string::npos);
+        size_t length = stoul(header.substr(0, separator), nullptr, 16);
+        EXPECT_LE(length, chunkSize);
+        string data = encoded.substr(headerEnd + 2, length);
+        EXPECT_EQ(encoded.substr(headerEnd + 2 + length, 2), "\r\n");
+
+        string stringToSign = string("JDCLOUD2-HMAC-SHA256-PAYLOAD\n") + DATE + "\n" + SCOPE + "\n" + previous + "\n" +
+                              "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855\n" +
+                              sha256.Calculate(data).GetResult().ToHexString();
+        previous = hmac.Calculate(stringToSign, key).GetResult().ToHexString();
+        EXPECT_EQ(header.substr(separator + 17), previous);
+
+        payload += data;
+        position = headerEnd + 2 + length + 2;
+        if (length == 0 || ::testing::Test::HasFailure()) {
+            break;
+        }
+    }
+    EXPECT_EQ(position, encoded.size());
+    return payload;
+}
+
+static Sha256HexDigest SeedSignature() {
+    Sha256 sha256;
+    return Sha256HexDigest(sha256.Calculate("request signature").GetResult());
+}
+
+TEST(ChunkedSigningStream, SignsChunksInOrder) {
+    const string key = "signing key";
+    const size_t chunkSize = 16;
+    for (size_t length : {0, 1, 15, 16, 17, 32, 100}) {
+        string payload;
+        for (size_t i = 0; i < length; ++i) {
+            payload += char('a' + i % 26);
+        }
+        ChunkedSigningStream stream(make_shared<stringstream>(payload), DATE, SCOPE, Sha256HMACMidstate(key),
+                                    SeedSignature(), chunkSize);
+        string encoded = ReadAll(stream);
+        EXPECT_EQ(Decode(encoded, key, SeedSignature().ToString(), chunkSize), payload) << length;
+        EXPECT_EQ(encoded.size(), ChunkedSigningStreambuf::GetEncodedLength(length, chunkSize)) << length;
+    }
+}
+
+TEST(ChunkedSigningStream, EncodedLength) {
+    const size_t chunkSize = ChunkedSigningStreambuf::DEFAULT_CHUNK_SIZE;
+    // 10000;chunk-signature=<64>\r\n<65536>\r\n, then 0;chunk-signature=<64>\r\n\r\n
+    EXPECT_EQ(ChunkedSigningStreambuf::GetEncodedLength(0), 86u);
+    EXPECT_EQ(ChunkedSigningStreambuf::GetEncodedLength(chunkSize), 86u + 90 + chunkSize);
+    EXPECT_EQ(ChunkedSigningStreambuf::GetEncodedLength(chunkSize + 1), 86u + 90 + chunkSize + 86 + 1);
+}
+
+TEST(ChunkedSigningStream, RewindsToStart) {
+    auto source = make_shared<stringstream>(string(100, 'x'));
+    ChunkedSigningStream stream(source, DATE, SCOPE, Sha256HMACMidstate(string("key")), SeedSignature(), 16);
+
+    char start[10];
+    stream.read(start, sizeof(start));
+    EXPECT_EQ(stream.tellg(), 10);
+    string first = ReadAll(stream);
+
+    stream.clear();
+    stream.seekg(0);
+    EXPECT_EQ(stream.tellg(), 0);
+    string again = ReadAll(stream);
+    EXPECT_EQ(string(start, sizeof(start)) + first, again);
+    EXPECT_EQ(stream.tellg(), (streamoff)again.size());
+
+    // only the start can be sought.
+    stream.clear();
+    stream.seekg(5);
+    EXPECT_TRUE(stream.fail());
+}
@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "jdcloud_signer/util/DateTime.h"
+
+using namespace jdcloud_signer;
+using namespace std;
+
+static void ExpectSameAsStrftime(const DateTime& dateTime) {
+    SigningDates dates;
+    dateTime.ToSigningDates(dates);
+    EXPECT_EQ(string(dates.longDate), dateTime.ToGmtString("%Y%m%dT%H%M%SZ")) << dateTime.Millis();
+    EXPECT_EQ(string(dates.shortDate), dateTime.ToGmtString("%Y%m%d")) << dateTime.Millis();
+}
+
+TEST(DateTime, SigningDates) {
+    SigningDates dates;
+    DateTime(INT64_C(1234567890000)).ToSigningDates(dates);
+    EXPECT_STREQ(dates.longDate, "20090213T233130Z");
+    EXPECT_STREQ(dates.shortDate, "20090213");
+
+    const int64_t boundaries[] = {
+        0, 999, 1000, -1, -1000, -1001,
+        INT64_C(951782399999), INT64_C(951782400000),   // 2000-02-28/29
+        INT64_C(951868800000), INT64_C(4107542400000),  // 2000-03-01, 2100-03-01
+        INT64_C(253402300799000),                       // 9999-12-31T23:59:59Z
+        INT64_C(-2208988800000)                         // 1900-01-01
+    };
+    for (int64_t millis : boundaries) {
+        ExpectSameAsStrftime(DateTime(millis));
+    }
+
+    mt19937_64 random(42);
+    uniform_int_distribution<int64_t> millis(INT64_C(-62135596800000), INT64_C(253402300799999));
+    for (int i = 0; i < 10000; ++i) {
+        ExpectSameAsStrftime(DateTime(millis(random)));
+    }
+}
+
+TEST(DateTime, SigningDatesSharedBetweenThreads) {
+    vector<thread> threads;
+    vector<char> ok(4, 0);
+    for (size_t t = 0; t < ok.size(); ++t) {
+        threads.emplace_back([&, t]() {
+            bool same = true;
+            for (int i = 0; i < 20000; ++i) {
+                // a handful of seconds so the cache is hit and replaced concurrently.
+                DateTime dateTime(INT64_C(1234567890000) + (i % 7) * 1000 + static_cast<int64_t>(t));
+                SigningDates dates;
+                dateTime.ToSigningDates(dates);
+                same = same && string(dates.longDate) == dateTime.ToGmtString("%Y%m%dT%H%M%SZ");
+            }
+            ok[t] = same ? 1 : 0;
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (char result : ok) {
+        EXPECT_EQ(result, 1);
+    }
+}
+
+TEST(DateTime, ClockSources) {
+    const ClockSource sources[] = {ClockSource::Precise, ClockSource::Coarse, ClockSource::CachedSecond};
+    for (ClockSource source : sources) {
+        int64_t before = DateTime::Now().Millis();
+        int64_t now = DateTime::Now(source).Millis();
+        int64_t after = DateTime::Now().Millis();
+        // coarse and cached sources may lag by up to their resolution.
+        EXPECT_GE(now, before - 1100) << static_cast<int>(source);
+        EXPECT_LE(now, after) << static_cast<int>(source);
+    }
+
+    // the cached second keeps moving.
+    int64_t first = DateTime::Now(ClockSource::CachedSecond).Millis();
+    int64_t latest = first;
+    for (int i = 0; i < 250 && latest == first; ++i) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+        latest = DateTime::Now(ClockSource::CachedSecond).Millis();
+    }
+    EXPECT_EQ(first % 1000, 0);
+    EXPECT_GT(latest, first);
+}
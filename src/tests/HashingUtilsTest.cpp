@@ -0,0 +1,58 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+#include "jdcloud_signer/util/crypto/HashingUtils.h"
+
+using namespace jdcloud_signer;
+using namespace std;
+
+static string ReferenceHex(const vector<unsigned char>& message) {
+    static const char DIGITS[] = "0123456789abcdef";
+    string hex;
+    for (unsigned char c : message) {
+        hex.push_back(DIGITS[c >> 4]);
+        hex.push_back(DIGITS[c & 0x0f]);
+    }
+    return hex;
+}
+
+TEST(HashingUtils, HexEncodeKernelsAgree) {
+    const HexKernel kernels[] = {HexKernel::Scalar, HexKernel::SSSE3, HexKernel::AVX2};
+    vector<unsigned char> message;
+    // every byte value, and lengths around the 16 and 32 byte vector widths.
+    for (size_t length = 0; length <= 300; ++length) {
+        message.push_back(static_cast<unsigned char>(length * 37 + 11));
+        string expected = ReferenceHex(message);
+        EXPECT_EQ(HashingUtils::HexEncode(message.data(), message.size()), expected);
+        for (HexKernel kernel : kernels) {
+            // unsupported kernels fall back to the scalar one.
+            string hex(2 * message.size() + 1, '#');
+            HashingUtils::HexEncode(message.data(), message.size(), &hex[0], kernel);
+            EXPECT_EQ(hex, expected + "#") << static_cast<int>(kernel) << "/" << message.size();
+        }
+    }
+}
+
+TEST(HashingUtils, HexDecode) {
+    unsigned char decoded[4] = {0};
+    ASSERT_TRUE(HashingUtils::HexDecode("00fFa9C1", 8, decoded));
+    EXPECT_EQ(decoded[0], 0x00);
+    EXPECT_EQ(decoded[1], 0xff);
+    EXPECT_EQ(decoded[2], 0xa9);
+    EXPECT_EQ(decoded[3], 0xc1);
+
+    EXPECT_FALSE(HashingUtils::HexDecode("abc", 3, decoded));
+    EXPECT_FALSE(HashingUtils::HexDecode("0g", 2, decoded));
+    EXPECT_FALSE(HashingUtils::HexDecode("- ", 2, decoded));
+    EXPECT_TRUE(HashingUtils::HexDecode("", 0, decoded));
+
+    vector<unsigned char> message;
+    for (int i = 0; i < 256; ++i) {
+        message.push_back(static_cast<unsigned char>(i));
+    }
+    string hex = HashingUtils::HexEncode(message.data(), message.size());
+    vector<unsigned char> roundTrip(message.size());
+    ASSERT_TRUE(HashingUtils::HexDecode(hex.data(), hex.size(), roundTrip.data()));
+    EXPECT_EQ(roundTrip, message);
+}
@@ -0,0 +1,150 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include "jdcloud_signer/http/HeaderValueCollection.h"
+#include "jdcloud_signer/http/HttpRequest.h"
+#include "jdcloud_signer/util/StringUtils.h"
+
+using namespace jdcloud_signer;
+using namespace std;
+
+static void ExpectSameHeaders(const HeaderValueCollection& headers, const map<string, string>& expected) {
+    ASSERT_EQ(headers.size(), expected.size());
+    auto iter = expected.begin();
+    for (const auto& header : headers) {
+        EXPECT_EQ(header.first, iter->first);
+        EXPECT_EQ(header.second, iter->second);
+        ++iter;
+    }
+}
+
+TEST(HeaderValueCollection, KeepsNameOrder) {
+    HeaderValueCollection headers;
+    map<string, string> expected;
+    for (const char* name : {"x-jdcloud-nonce", "content-type", "host", "x-jdcloud-date", "accept"}) {
+        headers.Set(name, string("value of ") + name);
+        expected[name] = string("value of ") + name;
+    }
+    ExpectSameHeaders(headers, expected);
+
+    headers.Set("host", "other");
+    expected["host"] = "other";
+    ExpectSameHeaders(headers, expected);
+
+    EXPECT_TRUE(headers.erase("content-type"));
+    EXPECT_FALSE(headers.erase("content-type"));
+    expected.erase("content-type");
+    ExpectSameHeaders(headers, expected);
+
+    EXPECT_EQ(headers.find("host")->second, "other");
+    EXPECT_EQ(headers.find("hos"), headers.end());
+    EXPECT_EQ(headers.find("hosts"), headers.end());
+}
+
+TEST(HeaderValueCollection, GrowsPastInlineCapacity) {
+    HeaderValueCollection headers;
+    map<string, string> expected;
+    // inserted back to front so that every one lands at the beginning.
+    for (size_t i = 3 * HeaderValueCollection::INLINE_CAPACITY; i > 0; --i) {
+        string name = "x-jdcloud-meta-" + to_string(100 + i);
+        headers.Set(string(name), to_string(i));
+        expected[name] = to_string(i);
+        if (i == HeaderValueCollection::INLINE_CAPACITY + 1) {
+            ExpectSameHeaders(headers, expected);
+        }
+    }
+    ExpectSameHeaders(headers, expected);
+
+    HeaderValueCollection copy = headers;
+    for (size_t i = 1; i <= 3 * HeaderValueCollection::INLINE_CAPACITY; i += 2) {
+        string name = "x-jdcloud-meta-" + to_string(100 + i);
+        EXPECT_TRUE(copy.erase(name));
+        expected.erase(name);
+    }
+    ExpectSameHeaders(copy, expected);
+
+    copy.clear();
+    EXPECT_TRUE(copy.empty());
+    copy.Set("host", "vm.cn-north-1.jdcloud-api.com");
+    ExpectSameHeaders(copy, {{"host", "vm.cn-north-1.jdcloud-api.com"}});
+}
+
+TEST(HeaderValueCollection, HttpRequestHeaders) {
+    HttpRequest request(URI("http://vm.cn-north-1.jdcloud-api.com/"), HttpMethod::HTTP_GET);
+    request.SetHeaderValue("Content-Type", "  application/json ");
+    request.SetHeaderValue(USER_AGENT_HEADER, "JdcloudSdkCpp/1.0.2");
+
+    ExpectSameHeaders(request.GetHeaders(), {
+        {"content-type", "application/json"},
+        {"host", "vm.cn-north-1.jdcloud-api.com"},
+        {"user-agent", "JdcloudSdkCpp/1.0.2"},
+    });
+    EXPECT_TRUE(request.HasHeader("CONTENT-TYPE"));
+    request.DeleteHeader("Content-Type");
+    EXPECT_FALSE(request.HasHeader("content-type"));
+    EXPECT_EQ(request.GetHeaderValue("content-type"), "");
+}
+
+TEST(HeaderValueCollection, CanonicalValueFollowsChanges) {
+    HeaderValueCollection headers;
+    headers.Set("content-type", "application/json");
+    headers.Set("x-jdcloud-meta", "a   b\n  c ");
+
+    auto contentType = headers.find("content-type");
+    EXPECT_EQ(&contentType->GetCanonicalValue(), &contentType->second);
+
+    auto meta = headers.find("x-jdcloud-meta");
+    const string* cached = &meta->GetCanonicalValue();
+    EXPECT_EQ(*cached, "a b,c");
+
+    // setting the same value again keeps what was cached, a new value is canonicalized again.
+    headers.Set("x-jdcloud-meta", "a   b\n  c ");
+    EXPECT_EQ(&headers.find("x-jdcloud-meta")->GetCanonicalValue(), cached);
+    headers.Set("x-jdcloud-meta", "d  e");
+    EXPECT_EQ(headers.find("x-jdcloud-meta")->GetCanonicalValue(), "d e");
+
+    // entries moving around on insert and erase take their canonical values along.
+    headers.Set("accept", "*/*");
+    EXPECT_EQ(headers.find("x-jdcloud-meta")->GetCanonicalValue(), "d e");
+    headers.erase("accept");
+    EXPECT_EQ(headers.find("x-jdcloud-meta")->GetCanonicalValue(), "d e");
+
+    for (const char* value : {"", " ", "a\nb", "a\n\nb", " a  b \n c  ", "a\tb", "a \t b"}) {
+        headers.Set("x-jdcloud-meta", value);
+        EXPECT_EQ(headers.find("x-jdcloud-meta")->GetCanonicalValue(), HeaderValueEntry::CanonicalizeValue(value)) << value;
+    }
+}
+
+// the canonicalization as it was written before the single pass one.
+static string CanonicalizeValueReference(const string& value) {
+    auto headerMultiLine = StringUtils::SplitOnLine(StringUtils::Trim(value.c_str()));
+    string headerValue = headerMultiLine.size() == 0 ? "" : headerMultiLine[0];
+    for (size_t i = 1; i < headerMultiLine.size(); ++i) {
+        headerValue += ",";
+        headerValue += StringUtils::Trim(headerMultiLine[i].c_str());
+    }
+    headerValue.erase(unique(headerValue.begin(), headerValue.end(), [](char lhs, char rhs) { return lhs == rhs && lhs == ' '; }),
+                      headerValue.end());
+    return headerValue;
+}
+
+TEST(HeaderValueCollection, CanonicalizeValueMatchesReference) {
+    const char alphabet[] = {' ', ' ', ' ', '\n', '\t', '\r', '\0', 'a', 'b', ','};
+    mt19937 random(42);
+    string canonicalValue;
+    for (size_t i = 0; i < 20000; ++i) {
+        // long enough for the vectorized scan to cover a few blocks.
+        string value(random() % 70, 'x');
+        for (auto& c : value) {
+            c = random() % 3 == 0 ? alphabet[random() % sizeof(alphabet)] : 'x';
+        }
+
+        string expected = CanonicalizeValueReference(value);
+        HeaderValueEntry::CanonicalizeValue(value, canonicalValue);
+        ASSERT_EQ(canonicalValue, expected) << "value: \"" << value << "\"";
+        ASSERT_EQ(HeaderValueEntry::IsCanonicalValue(value), value == expected) << "value: \"" << value << "\"";
+    }
+}
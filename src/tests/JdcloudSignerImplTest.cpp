@@ -1,10 +1,21 @@
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include "jdcloud_signer/ChunkedSigningStream.h"
+#include "jdcloud_signer/JdcloudSigner.h"
 #include "jdcloud_signer/JdcloudSignerImpl.h"
+#include "jdcloud_signer/util/crypto/Sha256.h"
+#include "jdcloud_signer/util/crypto/Sha256HMAC.h"
 
 using namespace jdcloud_signer;
 using namespace std;
 
+// counted by the operator new in CanonicalRequestBuilderTest.cpp.
+extern atomic<size_t> allocationCount;
+
 HttpRequest BuildAndSignRequestFromUrl(const string& url) {
     HttpRequest request(url, HttpMethod::HTTP_GET);
     Credential credential("ak", "sk");
@@ -16,6 +27,15 @@ HttpRequest BuildAndSignRequestFromUrl(const string& url) {
     return request;
 }
 
+// a streambuf that cannot seek, like a pipe's.
+class ForwardOnlyStreambuf : public stringbuf {
+public:
+    explicit ForwardOnlyStreambuf(const string& data) : stringbuf(data) {}
+protected:
+    pos_type seekoff(off_type, ios_base::seekdir, ios_base::openmode) override { return pos_type(off_type(-1)); }
+    pos_type seekpos(pos_type, ios_base::openmode) override { return pos_type(off_type(-1)); }
+};
+
 TEST(JdcloudSignerImpl, SignRequest) {
     auto request = BuildAndSignRequestFromUrl("http://vm.cn-north-1.jdcloud.net/");
     // TODO: #48
@@ -38,3 +58,369 @@ TEST(JdcloudSignerImpl, SignRequestWithEmptyQueryValue) {
     // EXPECT_EQ(auth1, auth4);
     EXPECT_EQ(auth1, auth5);
 }
+
+TEST(JdcloudSignerImpl, SignRequestsMatchesSignRequest) {
+    vector<string> urls = {"http://vm.cn-north-1.jdcloud.net/", "http://vm.cn-north-1.jdcloud.net/?b=&a="};
+    vector<HttpRequest> requests;
+    for (const auto& url : urls) {
+        requests.emplace_back(url, HttpMethod::HTTP_GET);
+    }
+
+    Credential credential("ak", "sk");
+    JdcloudSignerImpl signer(credential, "vm", "cn-north-1");
+    DateTime now(INT64_C(1234567890000));
+    auto results = signer.SignRequests(requests.data(), requests.size(), now, {"uuid", "uuid"});
+
+    ASSERT_EQ(results.size(), urls.size());
+    for (size_t i = 0; i < urls.size(); ++i) {
+        EXPECT_TRUE(results[i]);
+        EXPECT_EQ(requests[i].GetHeaderValue("authorization"), BuildAndSignRequestFromUrl(urls[i]).GetHeaderValue("authorization"));
+    }
+}
+
+TEST(JdcloudSignerImpl, SignRequestsReportsFailures) {
+    vector<HttpRequest> requests(2, HttpRequest("http://vm.cn-north-1.jdcloud.net/", HttpMethod::HTTP_GET));
+
+    Credential credential("ak", "");
+    JdcloudSignerImpl signer(credential, "vm", "cn-north-1");
+    auto results = signer.SignRequests(requests.data(), requests.size());
+
+    ASSERT_EQ(results.size(), requests.size());
+    EXPECT_FALSE(results[0]);
+    EXPECT_FALSE(results[1]);
+}
+
+TEST(JdcloudSignerImpl, ParallelSignRequestsMatchesSerial) {
+    const size_t count = 64;
+    vector<HttpRequest> serial, parallel;
+    vector<string> uuids;
+    for (size_t i = 0; i < count; ++i) {
+        HttpRequest request("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances?pageNumber=" + to_string(i), HttpMethod::HTTP_GET);
+        serial.push_back(request);
+        parallel.push_back(request);
+        uuids.push_back("uuid" + to_string(i));
+    }
+
+    Credential credential("ak", "sk");
+    JdcloudSignerImpl signer(credential, "vm", "cn-north-1");
+    DateTime now(INT64_C(1234567890000));
+    auto serialResults = signer.SignRequests(serial.data(), count, now, uuids);
+    auto parallelResults = signer.SignRequests(parallel.data(), count, 4, now, uuids);
+
+    EXPECT_EQ(serialResults, parallelResults);
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_TRUE(parallelResults[i]);
+        EXPECT_EQ(parallel[i].GetHeaderValue("authorization"), serial[i].GetHeaderValue("authorization"));
+    }
+}
+
+TEST(JdcloudSignerImpl, PreparedRequestMatchesSignRequest) {
+    auto build = [](const string& url, const string& contentType) {
+        HttpRequest request(url, HttpMethod::HTTP_GET);
+        request.SetHeaderValue("content-type", contentType);
+        request.SetHeaderValue("x-jdcloud-multiline", "a   b\n  c");
+        request.SetHeaderValue("user-agent", "JdcloudSdkCpp/1.0");
+        return request;
+    };
+
+    Credential credential("ak", "sk");
+    JdcloudSignerImpl signer(credential, "vm", "cn-north-1");
+    DateTime now(INT64_C(1234567890000));
+    auto prepared = signer.PrepareRequest(build("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances?b=2&a=1", "application/json"));
+    EXPECT_EQ(prepared.GetPreparedHeaderCount(), 3);
+
+    vector<HttpRequest> instances = {
+        build("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances?b=2&a=1", "application/json"),
+        build("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances?a=1&b=2", "application/json"),
+        build("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances?c=3", "text/plain  ;  charset=utf-8"),
+        build("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/disks", "application/json"),
+    };
+    instances[3].SetHeaderValue("x-jdcloud-extra", "x  \n y");
+    instances[3].DeleteHeader("x-jdcloud-multiline");
+
+    for (const auto& instance : instances) {
+        HttpRequest plain = instance, fromPrepared = instance;
+        ASSERT_TRUE(signer.SignRequest(plain, now, "uuid"));
+        ASSERT_TRUE(signer.SignRequest(fromPrepared, prepared, now, "uuid"));
+        EXPECT_EQ(fromPrepared.GetHeaderValue("authorization"), plain.GetHeaderValue("authorization"));
+        EXPECT_EQ(fromPrepared.GetQueryString(), plain.GetQueryString());
+    }
+}
+
+TEST(JdcloudSignerImpl, PrepareSharedTemplateFromManyThreads) {
+    // headers whose values are not canonical, so every thread needs their canonical forms.
+    HttpRequest request("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances?b=2&a=1", HttpMethod::HTTP_GET);
+    request.SetHeaderValue("content-type", "text/plain  ;  charset=utf-8");
+    request.SetHeaderValue("x-jdcloud-multiline", "a   b\n  c\n\n d");
+    const HttpRequest& shared = request;
+
+    Credential credential("ak", "sk");
+    JdcloudSignerImpl signer(credential, "vm", "cn-north-1");
+    DateTime now(INT64_C(1234567890000));
+    HttpRequest plain = shared;
+    ASSERT_TRUE(signer.SignRequest(plain, now, "uuid"));
+
+    const size_t threadCount = 8;
+    vector<string> authorizations(threadCount);
+    vector<thread> threads;
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&, i]() {
+            for (int round = 0; round < 50; ++round) {
+                auto prepared = signer.PrepareRequest(shared);
+                HttpRequest instance = shared;
+                signer.SignRequest(instance, prepared, now, "uuid");
+                authorizations[i] = instance.GetHeaderValue("authorization");
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (const auto& authorization : authorizations) {
+        EXPECT_EQ(authorization, plain.GetHeaderValue("authorization"));
+    }
+}
+
+TEST(JdcloudSignerImpl, PayloadHashIsRememberedPerBody) {
+    Credential credential("ak", "sk");
+    JdcloudSignerImpl signer(credential, "vm", "cn-north-1");
+    DateTime now(INT64_C(1234567890000));
+    auto sign = [&](HttpRequest& request) {
+        EXPECT_TRUE(signer.SignRequest(request, now, "uuid"));
+        return request.GetHeaderValue("authorization");
+    };
+    const string url = "http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances";
+    // sha256 of "payload"
+    const string payloadHash = "239f59ed55e737c77147cf55ad0c1b030b6d7ee748a7426952f9b852d5a935e5";
+
+    HttpRequest fresh(url, HttpMethod::HTTP_POST);
+    fresh.AddContentBody(make_shared<stringstream>("payload"));
+    string expected = sign(fresh);
+    EXPECT_EQ(fresh.GetPayloadHash(), payloadHash);
+
+    // re-signing does not read the body again, and leaves it where it is.
+    HttpRequest request(url, HttpMethod::HTTP_POST);
+    auto body = make_shared<stringstream>("payload");
+    request.AddContentBody(body);
+    EXPECT_EQ(request.GetPayloadHash(), "");
+    EXPECT_EQ(sign(request), expected);
+    body->str("changed");
+    body->seekg(3);
+    EXPECT_EQ(sign(request), expected);
+    EXPECT_EQ(body->tellg(), 3);
+
+    // a new body forgets the hash, even when it is the same stream.
+    uint64_t generation = request.GetContentBodyGeneration();
+    request.AddContentBody(body);
+    EXPECT_EQ(request.GetContentBodyGeneration(), generation + 1);
+    EXPECT_EQ(request.GetPayloadHash(), "");
+    EXPECT_NE(sign(request), expected);
+
+    // a hash the caller already has is used instead of the body, in either case.
+    HttpRequest precomputed(url, HttpMethod::HTTP_POST);
+    precomputed.AddContentBody(make_shared<stringstream>("not read"));
+    string upper = payloadHash;
+    transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+    precomputed.SetPayloadHash(upper);
+    EXPECT_EQ(sign(precomputed), expected);
+
+    // one that is not a sha256 is recomputed.
+    HttpRequest invalid(url, HttpMethod::HTTP_POST);
+    invalid.AddContentBody(make_shared<stringstream>("payload"));
+    invalid.SetPayloadHash("abc");
+    EXPECT_EQ(sign(invalid), expected);
+    EXPECT_EQ(invalid.GetPayloadHash(), payloadHash);
+
+    // nor is one of the right length that is not hex.
+    HttpRequest notHex(url, HttpMethod::HTTP_POST);
+    notHex.AddContentBody(make_shared<stringstream>("payload"));
+    notHex.SetPayloadHash("I5/Z7VXnN8dxR89VrQwbAwttfudIp0JpUvm4UtWpNeU=I5/Z7VXnN8dxR89VrQwb");
+    EXPECT_EQ(sign(notHex), expected);
+    EXPECT_EQ(notHex.GetPayloadHash(), payloadHash);
+}
+
+// the authorization for canonicalRequest, signed the long way with the key and time the tests use.
+static string AuthorizationFor(const string& canonicalRequest, const string& signedHeaders) {
+    Sha256 sha256;
+    Sha256HMAC hmac;
+    string key = "JDCLOUD2sk";
+    for (const char* scope : {"20090213", "cn-north-1", "vm", "jdcloud2_request"}) {
+        key = hmac.Calculate(scope, key).GetResult().ToString();
+    }
+    string stringToSign = "JDCLOUD2-HMAC-SHA256\n20090213T233130Z\n20090213/cn-north-1/vm/jdcloud2_request\n" +
+                          sha256.Calculate(canonicalRequest).GetResult().ToHexString();
+    return "JDCLOUD2-HMAC-SHA256 Credential=ak/20090213/cn-north-1/vm/jdcloud2_request, SignedHeaders=" +
+           signedHeaders + ", Signature=" + hmac.Calculate(stringToSign, key).GetResult().ToHexString();
+}
+
+TEST(JdcloudSignerImpl, UnsignedPayload) {
+    Credential credential("ak", "sk");
+    JdcloudSignerImpl signer(credential, "vm", "cn-north-1");
+    DateTime now(INT64_C(1234567890000));
+    const string canonicalRequest =
+        "PUT\n/v1/regions/cn-north-1/instances\n\n"
+        "host:vm.cn-north-1.jdcloud.net\nx-jdcloud-date:20090213T233130Z\nx-jdcloud-nonce:uuid\n\n"
+        "host;x-jdcloud-date;x-jdcloud-nonce\n";
+    auto build = [](PayloadSigning payloadSigning) {
+        HttpRequest request("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances", HttpMethod::HTTP_PUT);
+        request.AddContentBody(make_shared<stringstream>("payload"));
+        request.SetPayloadSigning(payloadSigning);
+        return request;
+    };
+
+    HttpRequest signedPayload = build(PayloadSigning::SIGNED);
+    EXPECT_EQ(signedPayload.GetPayloadSigning(), PayloadSigning::SIGNED);
+    ASSERT_TRUE(signer.SignRequest(signedPayload, now, "uuid"));
+    EXPECT_EQ(signedPayload.GetHeaderValue("authorization"),
+              AuthorizationFor(canonicalRequest + "239f59ed55e737c77147cf55ad0c1b030b6d7ee748a7426952f9b852d5a935e5",
+                               "host;x-jdcloud-date;x-jdcloud-nonce"));
+
+    // the marker takes the place of the hash, and the body is left alone.
+    HttpRequest unsignedPayload = build(PayloadSigning::UNSIGNED);
+    unsignedPayload.GetContentBody()->seekg(3);
+    ASSERT_TRUE(signer.SignRequest(unsignedPayload, now, "uuid"));
+    EXPECT_EQ(unsignedPayload.GetHeaderValue("authorization"),
+              AuthorizationFor(canonicalRequest + "UNSIGNED-PAYLOAD", "host;x-jdcloud-date;x-jdcloud-nonce"));
+    EXPECT_EQ(unsignedPayload.GetContentBody()->tellg(), 3);
+    EXPECT_EQ(unsignedPayload.GetPayloadHash(), "");
+
+    // with or without a body.
+    HttpRequest empty("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances", HttpMethod::HTTP_PUT);
+    empty.SetPayloadSigning(PayloadSigning::UNSIGNED);
+    ASSERT_TRUE(signer.SignRequest(empty, now, "uuid"));
+    EXPECT_EQ(empty.GetHeaderValue("authorization"), unsignedPayload.GetHeaderValue("authorization"));
+}
+
+TEST(JdcloudSignerImpl, StreamingPayload) {
+    Credential credential("ak", "sk");
+    JdcloudSignerImpl signer(credential, "vm", "cn-north-1");
+    DateTime now(INT64_C(1234567890000));
+    HttpRequest request("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances", HttpMethod::HTTP_PUT);
+    auto body = make_shared<stringstream>(string(100000, 'x'));
+    body->seekg(10);
+    request.AddContentBody(body);
+    request.SetHeaderValue("content-encoding", "gzip");
+    request.SetPayloadSigning(PayloadSigning::STREAMING);
+
+    ASSERT_TRUE(signer.SignRequest(request, now, "uuid"));
+    const string framedLength = to_string(JdcloudSigner::GetStreamingContentLength(100000));
+    EXPECT_EQ(request.GetHeaderValue("x-jdcloud-content-sha256"), "STREAMING-JDCLOUD2-HMAC-SHA256-PAYLOAD");
+    EXPECT_EQ(request.GetHeaderValue("x-jdcloud-decoded-content-length"), "100000");
+    EXPECT_EQ(request.GetHeaderValue("content-length"), framedLength);
+    EXPECT_EQ(request.GetHeaderValue("content-encoding"), "jdcloud-chunked,gzip");
+    const string signedHeaders = "content-encoding;content-length;host;x-jdcloud-content-sha256;x-jdcloud-date;"
+                                 "x-jdcloud-decoded-content-length;x-jdcloud-nonce";
+    string authorization = request.GetHeaderValue("authorization");
+    EXPECT_EQ(authorization,
+              AuthorizationFor("PUT\n/v1/regions/cn-north-1/instances\n\n"
+                               "content-encoding:jdcloud-chunked,gzip\ncontent-length:" + framedLength + "\n"
+                               "host:vm.cn-north-1.jdcloud.net\n"
+                               "x-jdcloud-content-sha256:STREAMING-JDCLOUD2-HMAC-SHA256-PAYLOAD\n"
+                               "x-jdcloud-date:20090213T233130Z\nx-jdcloud-decoded-content-length:100000\n"
+                               "x-jdcloud-nonce:uuid\n\n" + signedHeaders + "\n"
+                               "STREAMING-JDCLOUD2-HMAC-SHA256-PAYLOAD",
+                               signedHeaders));
+
+    // the body is now framed from its start, nothing of it has been read yet.
+    auto chunked = dynamic_pointer_cast<ChunkedSigningStream>(request.GetContentBody());
+    ASSERT_TRUE(chunked);
+    EXPECT_EQ(chunked->GetSource(), body);
+    EXPECT_EQ(body->tellg(), 0);
+    stringstream sent;
+    sent << chunked->rdbuf();
+    EXPECT_EQ(to_string(sent.str().size()), framedLength);
+    string seeded = sent.str();
+
+    // re-signing starts over from the plain body.
+    ASSERT_TRUE(signer.SignRequest(request, now, "uuid"));
+    EXPECT_EQ(request.GetHeaderValue("authorization"), authorization);
+    EXPECT_EQ(request.GetHeaderValue("content-encoding"), "jdcloud-chunked,gzip");
+    stringstream resent;
+    resent << request.GetContentBody()->rdbuf();
+    EXPECT_EQ(resent.str(), seeded);
+
+    // and so does switching back to a signed payload, with the headers of the plain body.
+    request.SetPayloadSigning(PayloadSigning::SIGNED);
+    ASSERT_TRUE(signer.SignRequest(request, now, "uuid"));
+    EXPECT_EQ(request.GetContentBody(), body);
+    EXPECT_FALSE(request.HasHeader("x-jdcloud-content-sha256"));
+    EXPECT_FALSE(request.HasHeader("x-jdcloud-decoded-content-length"));
+    EXPECT_EQ(request.GetHeaderValue("content-length"), "100000");
+    EXPECT_EQ(request.GetHeaderValue("content-encoding"), "gzip");
+}
+
+TEST(JdcloudSignerImpl, StreamingPayloadNeedsItsLength) {
+    ForwardOnlyStreambuf buffer("payload");
+
+    Credential credential("ak", "sk");
+    JdcloudSignerImpl signer(credential, "vm", "cn-north-1");
+    DateTime now(INT64_C(1234567890000));
+    HttpRequest request("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances", HttpMethod::HTTP_PUT);
+    request.AddContentBody(make_shared<iostream>(&buffer));
+    request.SetPayloadSigning(PayloadSigning::STREAMING);
+    EXPECT_FALSE(signer.SignRequest(request, now, "uuid"));
+    EXPECT_FALSE(request.HasHeader("authorization"));
+
+    request.SetHeaderValue("x-jdcloud-decoded-content-length", "seven");
+    EXPECT_FALSE(signer.SignRequest(request, now, "uuid"));
+
+    // the caller knows how much is left in a body that cannot seek.
+    request.SetHeaderValue("x-jdcloud-decoded-content-length", "7");
+    ASSERT_TRUE(signer.SignRequest(request, now, "uuid"));
+    EXPECT_EQ(request.GetHeaderValue("content-length"), to_string(JdcloudSigner::GetStreamingContentLength(7)));
+    EXPECT_EQ(request.GetHeaderValue("content-encoding"), "jdcloud-chunked");
+    string authorization = request.GetHeaderValue("authorization");
+
+    // and it can be signed again before any of it is sent.
+    ASSERT_TRUE(signer.SignRequest(request, now, "uuid"));
+    EXPECT_EQ(request.GetHeaderValue("authorization"), authorization);
+    EXPECT_EQ(request.GetHeaderValue("x-jdcloud-decoded-content-length"), "7");
+    EXPECT_EQ(request.GetHeaderValue("content-length"), to_string(JdcloudSigner::GetStreamingContentLength(7)));
+    stringstream sent;
+    sent << request.GetContentBody()->rdbuf();
+    EXPECT_EQ(to_string(sent.str().size()), request.GetHeaderValue("content-length"));
+}
+
+TEST(JdcloudSignerImpl, PayloadThatCannotSeek) {
+    ForwardOnlyStreambuf buffer("payload");
+    auto pipe = make_shared<iostream>(&buffer);
+
+    Credential credential("ak", "sk");
+    JdcloudSignerImpl signer(credential, "vm", "cn-north-1");
+    DateTime now(INT64_C(1234567890000));
+    HttpRequest request("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances", HttpMethod::HTTP_POST);
+    request.AddContentBody(pipe);
+    ASSERT_TRUE(signer.SignRequest(request, now, "uuid"));
+    EXPECT_EQ(request.GetPayloadHash(), "239f59ed55e737c77147cf55ad0c1b030b6d7ee748a7426952f9b852d5a935e5");
+
+    // the body is sent from the copy made while hashing it.
+    EXPECT_NE(request.GetContentBody(), pipe);
+    stringstream sent;
+    sent << request.GetContentBody()->rdbuf();
+    EXPECT_EQ(sent.str(), "payload");
+}
+
+TEST(JdcloudSignerImpl, NoAllocationInSteadyState) {
+    Credential credential("ak", "sk");
+    JdcloudSignerImpl signer(credential, "vm", "cn-north-1");
+    DateTime now(INT64_C(1234567890000));
+    const string uuid = "ed1d94ecab4a4bbd9ea6d5f35b0b6ccd";
+    HttpRequest request("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances?pageSize=10&pageNumber=2",
+                        HttpMethod::HTTP_POST);
+    request.SetHeaderValue("content-type", "application/json");
+    request.SetHeaderValue("user-agent", "JdcloudSdkCpp/1.0.2 vm/0.7.4");
+    request.AddContentBody(make_shared<stringstream>("payload"));
+
+    // the first signature fills the caches, the thread's signing context and the request's buffers. The time and
+    // nonce are passed in: SignRequest(request) returns a freshly generated nonce as a std::string, which is the
+    // one allocation left outside this test. The body hash is remembered after the first signature.
+    ASSERT_TRUE(signer.SignRequest(request, now, uuid));
+    string authorization = request.GetHeaderValue("authorization");
+
+    size_t before = allocationCount;
+    for (int i = 0; i < 100; ++i) {
+        signer.SignRequest(request, now, uuid);
+    }
+    EXPECT_EQ(allocationCount - before, 0u);
+    EXPECT_EQ(request.GetHeaderValue("authorization"), authorization);
+}
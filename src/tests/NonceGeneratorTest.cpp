@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include "jdcloud_signer/util/crypto/NonceGenerator.h"
+
+using namespace jdcloud_signer;
+using namespace std;
+
+TEST(NonceGenerator, Unique) {
+    set<string> nonces;
+    // several refills of the thread buffer.
+    for (size_t i = 0; i < 3 * NonceGenerator::BUFFER_LENGTH / NonceGenerator::NONCE_LENGTH; ++i) {
+        string nonce = NonceGenerator::GenerateHex();
+        ASSERT_EQ(nonce.size(), 2 * NonceGenerator::NONCE_LENGTH);
+        EXPECT_TRUE(nonces.insert(nonce).second);
+    }
+
+    // a batch larger than the buffer.
+    size_t count = 2 * NonceGenerator::BUFFER_LENGTH / NonceGenerator::NONCE_LENGTH + 1;
+    vector<unsigned char> batch(count * NonceGenerator::NONCE_LENGTH);
+    ASSERT_TRUE(NonceGenerator::Generate(batch.data(), count));
+    for (size_t i = 0; i < count; ++i) {
+        string nonce((const char*)batch.data() + i * NonceGenerator::NONCE_LENGTH, NonceGenerator::NONCE_LENGTH);
+        EXPECT_TRUE(nonces.insert(nonce).second);
+    }
+}
+
+TEST(NonceGenerator, UniqueAcrossThreads) {
+    const size_t perThread = 1000;
+    vector<vector<string>> generated(4);
+    vector<thread> threads;
+    for (size_t t = 0; t < generated.size(); ++t) {
+        threads.emplace_back([&, t]() {
+            for (size_t i = 0; i < perThread; ++i) {
+                generated[t].push_back(NonceGenerator::GenerateHex());
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    set<string> nonces;
+    for (const auto& list : generated) {
+        nonces.insert(list.begin(), list.end());
+    }
+    EXPECT_EQ(nonces.size(), generated.size() * perThread);
+}
+
+#ifndef WIN32
+TEST(NonceGenerator, ForkedChildDoesNotRepeatParent) {
+    // fill this thread's buffer, so the child inherits unused bytes.
+    NonceGenerator::GenerateHex();
+
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        string nonce = NonceGenerator::GenerateHex();
+        ssize_t written = write(fds[1], nonce.data(), nonce.size());
+        _exit(written == static_cast<ssize_t>(nonce.size()) ? 0 : 1);
+    }
+    close(fds[1]);
+
+    string parentNonce = NonceGenerator::GenerateHex();
+    char childNonce[2 * NonceGenerator::NONCE_LENGTH];
+    ssize_t got = read(fds[0], childNonce, sizeof(childNonce));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    ASSERT_EQ(got, static_cast<ssize_t>(sizeof(childNonce)));
+    EXPECT_NE(string(childNonce, sizeof(childNonce)), parentNonce);
+}
+#endif
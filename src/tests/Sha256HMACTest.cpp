@@ -0,0 +1,45 @@
+#include "gtest/gtest.h"
+
+#include "jdcloud_signer/util/crypto/Sha256.h"
+#include "jdcloud_signer/util/crypto/Sha256Builtin.h"
+#include "jdcloud_signer/util/crypto/Sha256HMAC.h"
+#include "jdcloud_signer/util/crypto/Sha256HMACMidstate.h"
+#include "jdcloud_signer/util/crypto/HashingUtils.h"
+
+using namespace jdcloud_signer;
+using namespace std;
+
+static const size_t lengths[] = {0, 1, 31, 32, 55, 56, 63, 64, 65, 119, 120, 128, 1000};
+
+TEST(Sha256Builtin, MatchesOpenssl) {
+    Sha256 sha256;
+    for (size_t length : lengths) {
+        string message(length, 'a');
+        unsigned char digest[32];
+        Sha256Builtin builtin;
+        builtin.Update((const unsigned char*)message.data(), message.size());
+        builtin.Final(digest);
+        EXPECT_EQ(HashingUtils::HexEncode(digest, 32), sha256.Calculate(message).GetResult().ToHexString()) << length;
+    }
+}
+
+TEST(Sha256HMACMidstate, MatchesSha256HMAC) {
+    Sha256HMAC hmac;
+    for (size_t keyLength : lengths) {
+        string key(keyLength, 'k');
+        Sha256HMACMidstate midstate(key);
+        for (size_t length : lengths) {
+            string message(length, 'm');
+            auto expected = hmac.Calculate(message, key).GetResult();
+            EXPECT_EQ(midstate.Calculate(message, Sha256Implementation::OpenSSL).GetResult(), expected) << keyLength << "/" << length;
+            EXPECT_EQ(midstate.Calculate(message, Sha256Implementation::Builtin).GetResult(), expected) << keyLength << "/" << length;
+        }
+    }
+}
+
+TEST(Sha256HMACMidstate, RestoredFromStates) {
+    Sha256HMACMidstate midstate(string(32, 'k'));
+    Sha256HMACMidstate restored(midstate.GetInnerState(), midstate.GetOuterState());
+    EXPECT_EQ(restored.Calculate("message").GetResult(), midstate.Calculate("message").GetResult());
+    EXPECT_FALSE(Sha256HMACMidstate().Calculate("message").IsSuccess());
+}
@@ -1,11 +1,61 @@
 #include "gtest/gtest.h"
 
+#include <thread>
+#include <vector>
 #include "jdcloud_signer/util/crypto/Sha256.h"
+#include "jdcloud_signer/util/crypto/Sha256HMAC.h"
 
 using namespace jdcloud_signer;
+using namespace std;
 
 TEST(Sha256, Calculate_String) {
     Sha256 sha256;
     auto result = sha256.Calculate("");
     ASSERT_TRUE(result.IsSuccess());
 }
+
+TEST(Sha256, PooledContextsAreResetBetweenCalls) {
+    const string emptyHash = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+    const string abcHash = "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+    // RFC 4231 test case 2
+    const string hmacHash = "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843";
+
+    vector<thread> threads;
+    vector<char> ok(4, 0);
+    for (size_t t = 0; t < ok.size(); ++t) {
+        threads.emplace_back([&, t]() {
+            Sha256 sha256;
+            Sha256HMAC hmac;
+            bool same = true;
+            for (int i = 0; i < 100; ++i) {
+                same = same && sha256.Calculate("abc").GetResult().ToHexString() == abcHash;
+                same = same && hmac.Calculate("what do ya want for nothing?", "Jefe").GetResult().ToHexString() == hmacHash;
+                same = same && sha256.Calculate("").GetResult().ToHexString() == emptyHash;
+            }
+            ok[t] = same ? 1 : 0;
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (char result : ok) {
+        EXPECT_EQ(result, 1);
+    }
+}
+
+TEST(Sha256, DigestIsRawUntilHexEncoded) {
+    Sha256 sha256;
+    auto result = sha256.Calculate("abc");
+    ASSERT_TRUE(result.IsSuccess());
+
+    const Sha256Digest& digest = result.GetResult();
+    EXPECT_EQ(digest.size(), 32u);
+    EXPECT_EQ(digest.data()[0], 0xba);
+    EXPECT_EQ(digest.data()[31], 0xad);
+
+    Sha256HexDigest hex(digest);
+    EXPECT_EQ(StringView(hex), StringView("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+    EXPECT_EQ(hex.ToString(), digest.ToHexString());
+    EXPECT_EQ(Sha256Digest(digest.data()), digest);
+    EXPECT_NE(sha256.Calculate("abd").GetResult(), digest);
+}
@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+
+#include "jdcloud_signer/SigningKeyCache.h"
+
+using namespace jdcloud_signer;
+using namespace std;
+
+TEST(SigningKeyCache, GetAfterPut) {
+    SigningKeyCache cache;
+    string id = SigningKeyCache::MakeSigningKeyId("sk", "cn-north-1", "vm");
+    Sha256HMACMidstate key(string(32, 'k'));
+    Sha256HMACMidstate cached;
+
+    ASSERT_EQ(id.size(), SigningKeyCache::ID_LENGTH);
+    EXPECT_FALSE(cache.Get(id, "20090213", cached));
+
+    cache.Put(id, "20090213", key);
+    ASSERT_TRUE(cache.Get(id, "20090213", cached));
+    EXPECT_EQ(cached.Calculate("message").GetResult(), key.Calculate("message").GetResult());
+
+    EXPECT_FALSE(cache.Get(id, "20090214", cached));
+    EXPECT_FALSE(cache.Get(SigningKeyCache::MakeSigningKeyId("sk", "cn-east-2", "vm"), "20090213", cached));
+}
+
+TEST(SigningKeyCache, NewDayEvictsPastDays) {
+    SigningKeyCache cache;
+    string id = SigningKeyCache::MakeSigningKeyId("sk", "cn-north-1", "vm");
+    string otherId = SigningKeyCache::MakeSigningKeyId("sk", "cn-north-1", "disk");
+    Sha256HMACMidstate key(string(32, 'k'));
+    Sha256HMACMidstate cached;
+
+    cache.Put(id, "20090213", key);
+    cache.Put(otherId, "20090214", key);
+
+    EXPECT_FALSE(cache.Get(id, "20090213", cached));
+    EXPECT_TRUE(cache.Get(otherId, "20090214", cached));
+}
+
+TEST(SigningKeyCache, BoundedCapacity) {
+    SigningKeyCache cache;
+    Sha256HMACMidstate key(string(32, 'k'));
+    Sha256HMACMidstate cached;
+
+    for (size_t i = 0; i < 4 * SigningKeyCache::SLOT_COUNT; ++i) {
+        cache.Put(SigningKeyCache::MakeSigningKeyId("sk", "region", to_string(i)), "20090213", key);
+    }
+
+    size_t hits = 0;
+    for (size_t i = 0; i < 4 * SigningKeyCache::SLOT_COUNT; ++i) {
+        if (cache.Get(SigningKeyCache::MakeSigningKeyId("sk", "region", to_string(i)), "20090213", cached)) {
+            ++hits;
+        }
+    }
+    EXPECT_LE(hits, SigningKeyCache::SLOT_COUNT);
+    EXPECT_GT(hits, 0u);
+}
@@ -0,0 +1,137 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include "jdcloud_signer/JdcloudSignerImpl.h"
+#include "jdcloud_signer/SpooledBodyStream.h"
+
+using namespace jdcloud_signer;
+using namespace std;
+
+// a source that can only be read forward once, like a pipe.
+class PipeStreambuf : public streambuf {
+public:
+    explicit PipeStreambuf(const string& data) : m_data(data), m_position(0) {}
+
+    size_t GetBytesRead() const { return m_position; }
+
+protected:
+    int_type underflow() override {
+        if (m_position == m_data.size()) {
+            return traits_type::eof();
+        }
+        // hands out a few bytes at a time, as a socket would.
+        size_t length = min<size_t>(1000, m_data.size() - m_position);
+        memcpy(m_chunk, m_data.data() + m_position, length);
+        m_position += length;
+        setg(m_chunk, m_chunk, m_chunk + length);
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    string m_data;
+    size_t m_position;
+    char m_chunk[1000];
+};
+
+class PipeStream : public iostream {
+public:
+    explicit PipeStream(const string& data) : iostream(nullptr), m_buffer(data) { rdbuf(&m_buffer); }
+
+    size_t GetBytesRead() const { return m_buffer.GetBytesRead(); }
+
+private:
+    PipeStreambuf m_buffer;
+};
+
+static string Payload(size_t length) {
+    string payload;
+    for (size_t i = 0; i < length; ++i) {
+        payload += char(i * 7 % 251);
+    }
+    return payload;
+}
+
+static string ReadAll(istream& stream) {
+    stringstream read;
+    read << stream.rdbuf();
+    return read.str();
+}
+
+TEST(SpooledBodyStream, IsSeekable) {
+    stringstream seekable("body");
+    PipeStream pipe("body");
+    EXPECT_TRUE(SpooledBodyStream::IsSeekable(seekable));
+    EXPECT_FALSE(SpooledBodyStream::IsSeekable(pipe));
+    SpooledBodyStream spooled(make_shared<PipeStream>("body"));
+    EXPECT_TRUE(SpooledBodyStream::IsSeekable(spooled));
+}
+
+TEST(SpooledBodyStream, ReplaysWhatWasRead) {
+    for (size_t memoryLimit : {size_t(0), size_t(100), SpooledBodyStreambuf::DEFAULT_MEMORY_LIMIT}) {
+        string payload = Payload(200000);
+        auto pipe = make_shared<PipeStream>(payload);
+        SpooledBodyStream stream(pipe, memoryLimit);
+
+        char start[300];
+        stream.read(start, sizeof(start));
+        EXPECT_EQ(string(start, sizeof(start)), payload.substr(0, sizeof(start)));
+        EXPECT_EQ(stream.tellg(), 300);
+
+        // back within what was read, then on past it.
+        stream.seekg(100);
+        EXPECT_EQ(ReadAll(stream), payload.substr(100));
+        EXPECT_EQ(stream.IsSpooledToFile(), memoryLimit < payload.size()) << memoryLimit;
+
+        stream.clear();
+        stream.seekg(0);
+        EXPECT_EQ(ReadAll(stream), payload) << memoryLimit;
+        EXPECT_EQ(pipe->GetBytesRead(), payload.size());
+    }
+}
+
+TEST(SpooledBodyStream, SeeksOnlyWhatWasRead) {
+    SpooledBodyStream stream(make_shared<PipeStream>("0123456789"));
+    stream.seekg(1);
+    EXPECT_TRUE(stream.fail());
+
+    stream.clear();
+    char digits[4];
+    stream.read(digits, sizeof(digits));
+    stream.seekg(-2, ios_base::cur);
+    EXPECT_EQ(stream.get(), '2');
+    stream.seekg(0, ios_base::end);
+    EXPECT_TRUE(stream.fail());
+}
+
+TEST(SpooledBodyStream, ReadBackThatFails) {
+    // a file the copy can be written to but not read back from.
+    const char* path = "SpooledBodyStreamTest.tmp";
+    auto writeOnly = [path]() { return fopen(path, "wb"); };
+
+    Credential credential("ak", "sk");
+    JdcloudSignerImpl signer(credential, "vm", "cn-north-1");
+    DateTime now(INT64_C(1234567890000));
+    for (bool failing : {false, true}) {
+        string payload = Payload(200000);
+        auto stream = failing ? make_shared<SpooledBodyStream>(make_shared<PipeStream>(payload), 0, writeOnly)
+                              : make_shared<SpooledBodyStream>(make_shared<PipeStream>(payload), 0);
+        // the first pass comes from the source.
+        EXPECT_EQ(ReadAll(*stream), payload);
+        EXPECT_TRUE(stream->IsSpooledToFile());
+        EXPECT_FALSE(stream->HasFailed());
+
+        // hashing reads the copy, and what ends early is not signed.
+        stream->clear();
+        stream->seekg(0);
+        HttpRequest request("http://vm.cn-north-1.jdcloud.net/v1/regions/cn-north-1/instances", HttpMethod::HTTP_POST);
+        request.AddContentBody(stream);
+        EXPECT_EQ(signer.SignRequest(request, now, "uuid"), !failing);
+        EXPECT_EQ(stream->HasFailed(), failing);
+        EXPECT_EQ(request.HasHeader("authorization"), !failing);
+    }
+    remove(path);
+}
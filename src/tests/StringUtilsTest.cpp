@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include "jdcloud_signer/util/StringUtils.h"
+
+using namespace jdcloud_signer;
+using namespace std;
+
+// the stringstream encoder URLEncode replaced.
+static string URLEncodeReference(const string& unsafe) {
+    stringstream escaped;
+    escaped.fill('0');
+    escaped << hex << uppercase;
+    for (char c : unsafe) {
+        if (c >= 0 && (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~')) {
+            escaped << c;
+        } else {
+            escaped << '%' << setw(2) << int((unsigned char)c) << setw(0);
+        }
+    }
+    return escaped.str();
+}
+
+TEST(StringUtils, URLEncode) {
+    EXPECT_EQ(StringUtils::URLEncode("a b+c/d~e"), "a%20b%2Bc%2Fd~e");
+    EXPECT_EQ(StringUtils::URLEncode("\xe4\xba\xac"), "%E4%BA%AC");
+    EXPECT_EQ(StringUtils::URLEncode(""), "");
+
+    string encoded("prefix");
+    StringUtils::URLEncode(StringView("$a&b", 4), encoded, URLSafeCharacters::Path);
+    EXPECT_EQ(encoded, "prefix$a&b");
+}
+
+TEST(StringUtils, URLEncodeMatchesReference) {
+    mt19937 random(7);
+    for (size_t i = 0; i < 5000; ++i) {
+        // mostly safe characters, so that the vectorized runs are long and end anywhere in a block.
+        string unsafe(random() % 100, 'x');
+        for (auto& c : unsafe) {
+            c = random() % 8 == 0 ? static_cast<char>(1 + random() % 255) : "az09AZ-_.~"[random() % 10];
+        }
+
+        string encoded;
+        StringUtils::URLEncode(unsafe, encoded);
+        ASSERT_EQ(encoded, URLEncodeReference(unsafe));
+        ASSERT_EQ(StringUtils::URLEncode(unsafe.c_str()), encoded);
+    }
+}
+
+TEST(StringUtils, TrimView) {
+    const char* inputs[] = {"", " ", "a", " a", "a ", "\t a b \r\n", "\v\f", " a\tb "};
+    for (const char* input : inputs) {
+        EXPECT_EQ(StringUtils::TrimView(input).ToString(), StringUtils::Trim(input)) << '"' << input << '"';
+        EXPECT_EQ(StringUtils::LTrimView(input).ToString(), StringUtils::LTrim(input)) << '"' << input << '"';
+        EXPECT_EQ(StringUtils::RTrimView(input).ToString(), StringUtils::RTrim(input)) << '"' << input << '"';
+    }
+
+    string source = "  value  ";
+    StringView trimmed = StringUtils::TrimView(source);
+    EXPECT_EQ(trimmed.data(), source.data() + 2);
+    EXPECT_EQ(trimmed.size(), 5u);
+}
+
+TEST(StringUtils, SplitView) {
+    const char* inputs[] = {"", "/", "a", "/a", "a/", "a//b", "//a/b//c//"};
+    for (const char* input : inputs) {
+        vector<string> expected = StringUtils::Split(input, '/');
+        vector<StringView> parts = StringUtils::SplitView(input, '/');
+        ASSERT_EQ(parts.size(), expected.size()) << input;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            EXPECT_EQ(parts[i].ToString(), expected[i]) << input;
+        }
+    }
+
+    vector<StringView> parts = {"stale"};
+    StringUtils::SplitView("a,b", ',', parts);
+    ASSERT_EQ(parts.size(), 2u);
+    EXPECT_EQ(parts[0], "a");
+    EXPECT_EQ(parts[1], "b");
+}
+
+TEST(StringUtils, ToLowerInPlace) {
+    string value = "Content-TYPE: X-Jdcloud-Date 09@[`{";
+    string expected = StringUtils::ToLower(value.c_str());
+    StringUtils::ToLowerInPlace(value);
+    EXPECT_EQ(value, expected);
+
+    EXPECT_TRUE(StringUtils::CaselessEquals("HTTP", "http"));
+    EXPECT_TRUE(StringUtils::CaselessEquals("", ""));
+    EXPECT_FALSE(StringUtils::CaselessEquals("http", "https"));
+    EXPECT_FALSE(StringUtils::CaselessEquals("@", "`"));
+}
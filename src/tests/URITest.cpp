@@ -1,8 +1,11 @@
 #include "gtest/gtest.h"
 
+#include <random>
 #include "jdcloud_signer/http/URI.h"
+#include "jdcloud_signer/util/StringUtils.h"
 
 using namespace jdcloud_signer;
+using namespace std;
 
 TEST(URI, CanonicalizeQueryString) {
     const char* testcases[][2] = {
@@ -12,9 +15,12 @@ TEST(URI, CanonicalizeQueryString) {
         // {"?a=&b", "?a=&b="},
         {"?a=&b=", "?a=&b="},
         {"?b=&a=", "?a=&b="},
-        // TODO: #50
-        // {"?a=1&a=2", "?a=1&a=2"},
-        // {"?a=2&a=1", "?a=1&a=2"}
+        {"?a=1&a=2", "?a=1&a=2"},
+        {"?a=2&a=1", "?a=1&a=2"},
+        {"?b=1&a=2&b=0&a=1", "?a=1&a=2&b=0&b=1"},
+        {"?a=1&&b=2", "?=&a=1&b=2"},
+        {"?b=2&a=1&", "?a=1&b=2"},
+        {"?a=b=c&a=b", "?a=b&a=b=c"},
     };
 
     for(int i = 0; i < sizeof(testcases)/sizeof(testcases[0]); ++i) {
@@ -23,3 +29,103 @@ TEST(URI, CanonicalizeQueryString) {
         EXPECT_EQ(url.GetQueryString(), testcases[i][1]);
     }
 }
+
+TEST(URI, ParseURIParts) {
+    struct {
+        const char* uri;
+        Scheme scheme;
+        const char* authority;
+        uint16_t port;
+        const char* path;
+        const char* queryString;
+    } testcases[] = {
+        {"http://vm.cn-north-1.jdcloud-api.com/v1/regions?a=1&b=2", Scheme::HTTP, "vm.cn-north-1.jdcloud-api.com", 80, "/v1/regions", "?a=1&b=2"},
+        {"https://vm.cn-north-1.jdcloud-api.com", Scheme::HTTPS, "vm.cn-north-1.jdcloud-api.com", 443, "/", ""},
+        {"HTTPS://host:8443/path/", Scheme::HTTPS, "host", 8443, "/path/", ""},
+        {"http://host:8080?x=1", Scheme::HTTP, "host", 8080, "/", "?x=1"},
+        {"http://host:/p", Scheme::HTTP, "host", 0, "/p", ""},
+        {"http://host/p?next=http://other/q", Scheme::HTTP, "host", 80, "/p", "?next=http://other/q"},
+        {"host/p:1", Scheme::HTTP, "host", 80, "/p:1", ""},
+        {"?a=&b=", Scheme::HTTP, "", 80, "/", "?a=&b="},
+    };
+
+    for (const auto& testcase : testcases) {
+        URI uri(testcase.uri);
+        EXPECT_EQ(uri.GetScheme(), testcase.scheme) << testcase.uri;
+        EXPECT_EQ(uri.GetAuthority(), testcase.authority) << testcase.uri;
+        EXPECT_EQ(uri.GetPort(), testcase.port) << testcase.uri;
+        EXPECT_EQ(uri.GetPath(), testcase.path) << testcase.uri;
+        EXPECT_EQ(uri.GetQueryString(), testcase.queryString) << testcase.uri;
+    }
+}
+
+TEST(URI, SetParts) {
+    URI uri("http://host/p?a=1");
+    uri.SetQueryString("b=2");
+    EXPECT_EQ(uri.GetQueryString(), "?b=2");
+    uri.SetPath("/longer/path");
+    uri.SetAuthority("other-host");
+    EXPECT_EQ(uri.GetAuthority(), "other-host");
+    EXPECT_EQ(uri.GetPath(), "/longer/path");
+    EXPECT_EQ(uri.GetQueryString(), "?b=2");
+    uri.AddQueryStringParameter("c", "3 4");
+    EXPECT_EQ(uri.GetQueryString(), "?b=2&c=3%204");
+    EXPECT_EQ(uri.GetURIString(), "http://other-host/longer/path?b=2&c=3%204");
+    uri.SetQueryString("");
+    EXPECT_EQ(uri.GetURIString(), "http://other-host/longer/path");
+    EXPECT_TRUE(uri == URI("http://other-host/longer/path"));
+}
+
+// the split based path encoders URLEncodePath and URLEncodePathRFC3986 replaced.
+static string URLEncodePathReference(const string& path) {
+    string encoded;
+    for (const auto& segment : StringUtils::Split(path, '/')) {
+        encoded += "/" + StringUtils::URLEncode(segment.c_str());
+    }
+    if (!path.empty() && path.back() == '/') {
+        encoded += "/";
+    }
+    return encoded;
+}
+
+static string URLEncodePathRFC3986Reference(const string& path) {
+    if (path.empty()) {
+        return path;
+    }
+    string encoded;
+    char escape[4];
+    for (const auto& segment : StringUtils::Split(path, '/')) {
+        encoded += '/';
+        for (unsigned char c : segment) {
+            if (isalnum(c) || string("-_.~$&,/:;=@").find(c) != string::npos) {
+                encoded += c;
+            } else {
+                snprintf(escape, sizeof(escape), "%%%02X", c);
+                encoded += escape;
+            }
+        }
+    }
+    if (path.back() == '/') {
+        encoded += '/';
+    }
+    return encoded;
+}
+
+TEST(URI, URLEncodePath) {
+    EXPECT_EQ(URI::URLEncodePath("/v1/regions/cn-north-1/instances"), "/v1/regions/cn-north-1/instances");
+    EXPECT_EQ(URI::URLEncodePath("a//b c/"), "/a/b%20c/");
+    EXPECT_EQ(URI::URLEncodePath("/"), "/");
+    EXPECT_EQ(URI::URLEncodePath(""), "");
+    EXPECT_EQ(URI::URLEncodePathRFC3986("/a b/$&,:;=@/~"), "/a%20b/$&,:;=@/~");
+    EXPECT_EQ(URI::URLEncodePathRFC3986(""), "");
+
+    mt19937 random(11);
+    for (size_t i = 0; i < 5000; ++i) {
+        string path(random() % 120, 'x');
+        for (auto& c : path) {
+            c = random() % 6 == 0 ? static_cast<char>(random() % 256) : "az09/-_.~$&,:;=@"[random() % 16];
+        }
+        ASSERT_EQ(URI::URLEncodePath(path), URLEncodePathReference(path));
+        ASSERT_EQ(URI::URLEncodePathRFC3986(path), URLEncodePathRFC3986Reference(path));
+    }
+}
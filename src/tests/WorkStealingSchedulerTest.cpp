@@ -0,0 +1,58 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "jdcloud_signer/util/WorkStealingScheduler.h"
+
+using namespace jdcloud_signer;
+using namespace std;
+
+TEST(WorkStealingScheduler, RunsEveryIndexOnce) {
+    const size_t counts[] = {0, 1, 7, 1000};
+    const size_t workerCounts[] = {1, 2, 3, 8};
+
+    for (size_t count : counts) {
+        for (size_t workerCount : workerCounts) {
+            vector<atomic<int>> runs(count);
+            for (auto& run : runs) {
+                run = 0;
+            }
+            atomic<bool> badWorker(false);
+
+            WorkStealingScheduler::Run(count, workerCount, [&](size_t worker, size_t index) {
+                if (worker >= workerCount) {
+                    badWorker = true;
+                }
+                ++runs[index];
+            });
+
+            EXPECT_FALSE(badWorker);
+            for (size_t i = 0; i < count; ++i) {
+                EXPECT_EQ(runs[i], 1) << count << "/" << workerCount << "/" << i;
+            }
+        }
+    }
+}
+
+TEST(WorkStealingScheduler, StealsFromBusyWorker) {
+    // all the slow items start in worker 0's share, the others must take some of them over.
+    const size_t count = 64;
+    vector<size_t> workerOfIndex(count);
+
+    WorkStealingScheduler::Run(count, 4, [&](size_t worker, size_t index) {
+        workerOfIndex[index] = worker;
+        if (index < count / 4) {
+            this_thread::sleep_for(chrono::milliseconds(2));
+        }
+    });
+
+    size_t stolen = 0;
+    for (size_t i = 0; i < count / 4; ++i) {
+        if (workerOfIndex[i] != 0) {
+            ++stolen;
+        }
+    }
+    EXPECT_GT(stolen, 0u);
+}
@@ -15,10 +15,23 @@
 // NOTE: This file is modified from AWS V4 Signer algorithm.
 
 #include "jdcloud_signer/util/DateTime.h"
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <ctime>
 #include <cassert>
 #include <iostream>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#ifdef __linux__
+#include <time.h>
+#endif
+#ifndef WIN32
+#include <pthread.h>
+#endif
 
 using namespace std;
 
@@ -26,6 +39,211 @@ namespace jdcloud_signer {
 
 static const char* RFC822_DATE_FORMAT_STR_WITH_Z = "%a, %d %b %Y %H:%M:%S %Z";
 static const char* ISO_8601_LONG_DATE_FORMAT_STR = "%Y-%m-%dT%H:%M:%SZ";
+static const char* SIGNING_LONG_DATE_FORMAT_STR = "%Y%m%dT%H%M%SZ";
+static const int64_t SECONDS_PER_DAY = 86400;
+
+const size_t SigningDates::LONG_DATE_LENGTH;
+const size_t SigningDates::SHORT_DATE_LENGTH;
+
+namespace {
+
+/**
+ * The last formatted second and its long date (the short date is its first 8 characters), guarded by a sequence
+ * counter: odd while written, readers that see it change retry by formatting themselves.
+ */
+struct SigningDatesCache
+{
+    SigningDatesCache() : sequence(0), second(INT64_MIN)
+    {
+        words[0].store(0, std::memory_order_relaxed);
+        words[1].store(0, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint32_t> sequence;
+    std::atomic<int64_t> second;
+    std::atomic<uint64_t> words[2];
+};
+
+SigningDatesCache signingDatesCache;
+
+bool GetCachedSigningDates(int64_t second, char* longDate)
+{
+    uint32_t sequence = signingDatesCache.sequence.load(std::memory_order_acquire);
+    if (sequence & 1)
+    {
+        return false;
+    }
+    bool hit = signingDatesCache.second.load(std::memory_order_relaxed) == second;
+    uint64_t words[2] = {
+        signingDatesCache.words[0].load(std::memory_order_relaxed),
+        signingDatesCache.words[1].load(std::memory_order_relaxed)
+    };
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!hit || signingDatesCache.sequence.load(std::memory_order_relaxed) != sequence)
+    {
+        return false;
+    }
+    memcpy(longDate, words, SigningDates::LONG_DATE_LENGTH);
+    return true;
+}
+
+void PutCachedSigningDates(int64_t second, const char* longDate)
+{
+    uint32_t sequence = signingDatesCache.sequence.load(std::memory_order_relaxed);
+    // somebody else is writing, they will cache it.
+    if ((sequence & 1) || !signingDatesCache.sequence.compare_exchange_strong(sequence, sequence + 1,
+                                                                             std::memory_order_acquire))
+    {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    uint64_t words[2];
+    memcpy(words, longDate, SigningDates::LONG_DATE_LENGTH);
+    signingDatesCache.second.store(second, std::memory_order_relaxed);
+    signingDatesCache.words[0].store(words[0], std::memory_order_relaxed);
+    signingDatesCache.words[1].store(words[1], std::memory_order_relaxed);
+    signingDatesCache.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+/**
+ * The current second for ClockSource::CachedSecond. NOT_STARTED until the ticker thread runs, reads fall back to
+ * the system clock meanwhile.
+ */
+const int64_t NOT_STARTED = INT64_MIN;
+std::atomic<int64_t> tickerSecond(NOT_STARTED);
+std::atomic<bool> tickerStarting(false);
+
+int64_t SystemSecond()
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * The thread that moves tickerSecond along, stopped and joined when the ticker is destroyed.
+ */
+class Ticker
+{
+public:
+    Ticker() :
+        m_stopping(false),
+        m_thread(&Ticker::Run, this)
+    {
+    }
+
+    ~Ticker()
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+
+private:
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        while (!m_stopping)
+        {
+            auto now = std::chrono::system_clock::now().time_since_epoch();
+            tickerSecond.store(std::chrono::duration_cast<std::chrono::seconds>(now).count(), std::memory_order_release);
+
+            // wake just past the next second boundary of the system clock. The wait itself runs on the steady
+            // clock, so a jump of the system clock delays a tick by at most a second.
+            auto intoSecond = std::chrono::duration_cast<std::chrono::microseconds>(now) % std::chrono::seconds(1);
+            m_wake.wait_for(lock, std::chrono::seconds(1) - intoSecond + std::chrono::microseconds(50),
+                            [this]() { return m_stopping; });
+        }
+    }
+
+    std::mutex m_lock;
+    std::condition_variable m_wake;
+    bool m_stopping;
+    // last, so it starts once the rest is initialized.
+    std::thread m_thread;
+};
+
+/**
+ * Owns the ticker, so it is stopped when static objects are destroyed at exit or when the library is unloaded.
+ */
+struct TickerOwner
+{
+    std::unique_ptr<Ticker> ticker;
+
+    ~TickerOwner()
+    {
+        ticker.reset();
+        // nothing restarts it from here on, late reads use the system clock.
+        tickerStarting.store(true, std::memory_order_relaxed);
+        tickerSecond.store(NOT_STARTED, std::memory_order_release);
+    }
+};
+
+TickerOwner& GetTickerOwner()
+{
+    static TickerOwner owner;
+    return owner;
+}
+
+#ifndef WIN32
+void OnForkChild()
+{
+    // the ticker thread does not survive fork(), so its ticker can neither be stopped nor joined and is left
+    // behind. The next read starts a new one.
+    (void)GetTickerOwner().ticker.release();
+    tickerSecond.store(NOT_STARTED, std::memory_order_relaxed);
+    tickerStarting.store(false, std::memory_order_relaxed);
+}
+#endif
+
+int64_t CachedSecond()
+{
+    int64_t second = tickerSecond.load(std::memory_order_acquire);
+    if (second != NOT_STARTED)
+    {
+        return second;
+    }
+
+    bool expected = false;
+    if (tickerStarting.compare_exchange_strong(expected, true))
+    {
+#ifndef WIN32
+        static bool forkHandlerRegistered = pthread_atfork(nullptr, nullptr, OnForkChild) == 0;
+        (void)forkHandlerRegistered;
+#endif
+        tickerSecond.store(SystemSecond(), std::memory_order_release);
+        GetTickerOwner().ticker.reset(new Ticker);
+    }
+    return SystemSecond();
+}
+
+inline void WriteDigits(char* out, int value, int digits)
+{
+    for (int i = digits - 1; i >= 0; --i)
+    {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+/**
+ * Proleptic Gregorian year, month (1-12) and day of a count of days since 1970-01-01.
+ */
+void CivilFromDays(int64_t days, int64_t& year, int& month, int& day)
+{
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t shiftedMonth = (5 * dayOfYear + 2) / 153;
+    day = static_cast<int>(dayOfYear - (153 * shiftedMonth + 2) / 5 + 1);
+    month = static_cast<int>(shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9);
+    year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+}
+
+}
 
 DateTime::DateTime(const std::chrono::system_clock::time_point& timepointToAssign) : m_time(timepointToAssign), m_valid(true)
 {
@@ -142,6 +360,47 @@ string DateTime::ToGmtString(const char* formatStr) const
     return formattedString;
 }
 
+void DateTime::ToSigningDates(SigningDates& dates) const
+{
+    // truncated like to_time_t, so the dates always match ToGmtString.
+    int64_t second = std::chrono::duration_cast<std::chrono::seconds>(m_time.time_since_epoch()).count();
+
+    if (!GetCachedSigningDates(second, dates.longDate))
+    {
+        int64_t days = second / SECONDS_PER_DAY - (second % SECONDS_PER_DAY < 0 ? 1 : 0);
+        int64_t secondOfDay = second - days * SECONDS_PER_DAY;
+        int64_t year;
+        int month;
+        int day;
+        CivilFromDays(days, year, month, day);
+
+        if (year < 0 || year > 9999)
+        {
+            // not four digits, leave it to strftime.
+            string longDate = ToGmtString(SIGNING_LONG_DATE_FORMAT_STR);
+            memset(dates.longDate, 0, sizeof(dates.longDate));
+            memcpy(dates.longDate, longDate.data(), std::min(longDate.size(), SigningDates::LONG_DATE_LENGTH));
+        }
+        else
+        {
+            char* out = dates.longDate;
+            WriteDigits(out, static_cast<int>(year), 4);
+            WriteDigits(out + 4, month, 2);
+            WriteDigits(out + 6, day, 2);
+            out[8] = 'T';
+            WriteDigits(out + 9, static_cast<int>(secondOfDay / 3600), 2);
+            WriteDigits(out + 11, static_cast<int>(secondOfDay / 60 % 60), 2);
+            WriteDigits(out + 13, static_cast<int>(secondOfDay % 60), 2);
+            out[15] = 'Z';
+            PutCachedSigningDates(second, out);
+        }
+    }
+
+    dates.longDate[SigningDates::LONG_DATE_LENGTH] = '\0';
+    memcpy(dates.shortDate, dates.longDate, SigningDates::SHORT_DATE_LENGTH);
+    dates.shortDate[SigningDates::SHORT_DATE_LENGTH] = '\0';
+}
+
 double DateTime::SecondsWithMSPrecision() const
 {
     std::chrono::duration<double, std::chrono::seconds::period> timestamp(m_time.time_since_epoch());
@@ -171,6 +430,28 @@ DateTime DateTime::Now()
     return dateTime;
 }
 
+DateTime DateTime::Now(ClockSource source)
+{
+    switch (source)
+    {
+    case ClockSource::CachedSecond:
+        return DateTime(static_cast<int64_t>(CachedSecond() * 1000));
+    case ClockSource::Coarse:
+    {
+#if defined(__linux__) && defined(CLOCK_REALTIME_COARSE)
+        struct timespec now;
+        if (clock_gettime(CLOCK_REALTIME_COARSE, &now) == 0)
+        {
+            return DateTime(static_cast<int64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1000000);
+        }
+#endif
+        return Now();
+    }
+    default:
+        return Now();
+    }
+}
+
 std::chrono::milliseconds DateTime::Diff(const DateTime& a, const DateTime& b)
 {
     auto diff = a.m_time - b.m_time;
@@ -27,10 +27,166 @@
 #include <Windows.h>
 #endif
 
+// SSE2 is the baseline, AVX2 is picked at run time.
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__)
+#define JDCLOUD_SIGNER_X86_URL_KERNELS
+#include <immintrin.h>
+#endif
+
 using namespace std;
 
 namespace jdcloud_signer {
 
+namespace {
+
+// which characters each URLSafeCharacters set keeps, one bit per set, and the escape of every byte.
+struct URLEncodeTable
+{
+    URLEncodeTable()
+    {
+        static const char DIGITS[] = "0123456789ABCDEF";
+        for (int c = 0; c < 256; ++c)
+        {
+            bool unreserved = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+                || c == '-' || c == '_' || c == '.' || c == '~';
+            bool path = unreserved || c == '$' || c == '&' || c == ',' || c == '/' || c == ':' || c == ';'
+                || c == '=' || c == '@';
+            safe[c] = (unreserved ? Bit(URLSafeCharacters::Unreserved) : 0) | (path ? Bit(URLSafeCharacters::Path) : 0);
+            escapes[3 * c] = '%';
+            escapes[3 * c + 1] = DIGITS[c >> 4];
+            escapes[3 * c + 2] = DIGITS[c & 0x0f];
+        }
+    }
+
+    static inline unsigned char Bit(URLSafeCharacters set) { return 1 << static_cast<int>(set); }
+
+    unsigned char safe[256];
+    char escapes[768];
+};
+
+// built on first use, like the hex table.
+const URLEncodeTable& GetURLEncodeTable()
+{
+    static const URLEncodeTable table;
+    return table;
+}
+
+size_t SafeRunEndScalar(const unsigned char* data, size_t begin, size_t end, unsigned char bit)
+{
+    const URLEncodeTable& table = GetURLEncodeTable();
+    while (begin < end && (table.safe[data[begin]] & bit))
+    {
+        ++begin;
+    }
+    return begin;
+}
+
+#ifdef JDCLOUD_SIGNER_X86_URL_KERNELS
+// both kernels test a block of bytes against the ranges and single characters of the set with signed compares,
+// bytes from 0x80 up are negative and never match. The first byte that is not safe ends the run.
+
+inline __m128i InRange(__m128i bytes, char low, char high)
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(low - 1)), _mm_cmpgt_epi8(_mm_set1_epi8(high + 1), bytes));
+}
+
+inline __m128i Equals(__m128i bytes, char c)
+{
+    return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(c));
+}
+
+size_t SafeRunEndSSE2(const unsigned char* data, size_t begin, size_t end, URLSafeCharacters set)
+{
+    bool path = set == URLSafeCharacters::Path;
+    for (; begin + 16 <= end; begin += 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + begin));
+        __m128i letters = InRange(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), 'a', 'z');
+        __m128i safe = _mm_or_si128(_mm_or_si128(letters, Equals(bytes, '_')), Equals(bytes, '~'));
+        if (path)
+        {
+            // ,-./0-9:; are contiguous.
+            safe = _mm_or_si128(safe, InRange(bytes, ',', ';'));
+            safe = _mm_or_si128(safe, _mm_or_si128(_mm_or_si128(Equals(bytes, '$'), Equals(bytes, '&')),
+                                                   _mm_or_si128(Equals(bytes, '='), Equals(bytes, '@'))));
+        }
+        else
+        {
+            safe = _mm_or_si128(safe, _mm_or_si128(InRange(bytes, '0', '9'), InRange(bytes, '-', '.')));
+        }
+
+        unsigned unsafe = ~static_cast<unsigned>(_mm_movemask_epi8(safe)) & 0xffff;
+        if (unsafe != 0)
+        {
+            return begin + __builtin_ctz(unsafe);
+        }
+    }
+    return SafeRunEndScalar(data, begin, end, URLEncodeTable::Bit(set));
+}
+
+__attribute__((target("avx2")))
+inline __m256i InRange(__m256i bytes, char low, char high)
+{
+    return _mm256_and_si256(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8(low - 1)),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(high + 1), bytes));
+}
+
+__attribute__((target("avx2")))
+inline __m256i Equals(__m256i bytes, char c)
+{
+    return _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(c));
+}
+
+__attribute__((target("avx2")))
+size_t SafeRunEndAVX2(const unsigned char* data, size_t begin, size_t end, URLSafeCharacters set)
+{
+    bool path = set == URLSafeCharacters::Path;
+    for (; begin + 32 <= end; begin += 32)
+    {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + begin));
+        __m256i letters = InRange(_mm256_or_si256(bytes, _mm256_set1_epi8(0x20)), 'a', 'z');
+        __m256i safe = _mm256_or_si256(_mm256_or_si256(letters, Equals(bytes, '_')), Equals(bytes, '~'));
+        if (path)
+        {
+            safe = _mm256_or_si256(safe, InRange(bytes, ',', ';'));
+            safe = _mm256_or_si256(safe, _mm256_or_si256(_mm256_or_si256(Equals(bytes, '$'), Equals(bytes, '&')),
+                                                         _mm256_or_si256(Equals(bytes, '='), Equals(bytes, '@'))));
+        }
+        else
+        {
+            safe = _mm256_or_si256(safe, _mm256_or_si256(InRange(bytes, '0', '9'), InRange(bytes, '-', '.')));
+        }
+
+        unsigned unsafe = ~static_cast<unsigned>(_mm256_movemask_epi8(safe));
+        if (unsafe != 0)
+        {
+            return begin + __builtin_ctz(unsafe);
+        }
+    }
+    return SafeRunEndSSE2(data, begin, end, set);
+}
+
+bool HasAVX2()
+{
+    static const bool avx2 = []() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return avx2;
+}
+#endif
+
+size_t SafeRunEnd(const unsigned char* data, size_t begin, size_t end, URLSafeCharacters set)
+{
+#ifdef JDCLOUD_SIGNER_X86_URL_KERNELS
+    return HasAVX2() ? SafeRunEndAVX2(data, begin, end, set) : SafeRunEndSSE2(data, begin, end, set);
+#else
+    return SafeRunEndScalar(data, begin, end, URLEncodeTable::Bit(set));
+#endif
+}
+
+}
+
 void StringUtils::Replace(string& s, const char* search, const char* replace)
 {
     if(!search || !replace)
@@ -77,10 +233,82 @@ string StringUtils::ToUpper(const char* source)
 
 bool StringUtils::CaselessCompare(const char* value1, const char* value2)
 {
-    string value1Lower = ToLower(value1);
-    string value2Lower = ToLower(value2);
+    return CaselessEquals(value1, value2);
+}
+
+void StringUtils::ToLowerInPlace(string& source)
+{
+    for (auto& c : source)
+    {
+        c = ToLower(c);
+    }
+}
+
+bool StringUtils::CaselessEquals(StringView value1, StringView value2)
+{
+    if (value1.size() != value2.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < value1.size(); ++i)
+    {
+        if (ToLower(value1[i]) != ToLower(value2[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+StringView StringUtils::LTrimView(StringView source)
+{
+    size_t begin = 0;
+    while (begin < source.size() && IsSpace(source[begin]))
+    {
+        ++begin;
+    }
+    return source.substr(begin);
+}
+
+StringView StringUtils::RTrimView(StringView source)
+{
+    size_t end = source.size();
+    while (end > 0 && IsSpace(source[end - 1]))
+    {
+        --end;
+    }
+    return source.substr(0, end);
+}
+
+StringView StringUtils::TrimView(StringView source)
+{
+    return LTrimView(RTrimView(source));
+}
+
+void StringUtils::SplitView(StringView toSplit, char splitOn, vector<StringView>& parts)
+{
+    parts.clear();
+    size_t begin = 0;
+    while (begin < toSplit.size())
+    {
+        size_t end = toSplit.find(splitOn, begin);
+        if (end == StringView::npos)
+        {
+            end = toSplit.size();
+        }
+        if (end > begin)
+        {
+            parts.push_back(toSplit.substr(begin, end - begin));
+        }
+        begin = end + 1;
+    }
+}
 
-    return value1Lower == value2Lower;
+vector<StringView> StringUtils::SplitView(StringView toSplit, char splitOn)
+{
+    vector<StringView> parts;
+    SplitView(toSplit, splitOn, parts);
+    return parts;
 }
 
 vector<string> StringUtils::Split(const string& toSplit, char splitOn)
@@ -129,28 +357,28 @@ vector<string> StringUtils::SplitOnLine(const string& toSplit)
 
 string StringUtils::URLEncode(const char* unsafe)
 {
-    stringstream escaped;
-    escaped.fill('0');
-    escaped << std::hex << std::uppercase;
+    string escaped;
+    URLEncode(unsafe, escaped);
+    return escaped;
+}
+
+void StringUtils::URLEncode(StringView unsafe, string& encoded, URLSafeCharacters safe)
+{
+    const URLEncodeTable& table = GetURLEncodeTable();
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(unsafe.data());
+    unsigned char bit = URLEncodeTable::Bit(safe);
+    size_t length = unsafe.size();
 
-    size_t unsafeLength = strlen(unsafe);
-    for (auto i = unsafe, n = unsafe + unsafeLength; i != n; ++i)
+    size_t i = 0;
+    while (i < length)
     {
-        int c = *i;
-        //MSVC 2015 has an assertion that c is positive in isalnum(). This breaks unicode support.
-        //bypass that with the first check.
-        if (c >= 0 && (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~'))
+        size_t runEnd = SafeRunEnd(data, i, length, safe);
+        encoded.append(unsafe.data() + i, runEnd - i);
+        for (i = runEnd; i < length && !(table.safe[data[i]] & bit); ++i)
         {
-            escaped << (char)c;
-        }
-        else
-        {
-            //this unsigned char cast allows us to handle unicode characters.
-            escaped << '%' << std::setw(2) << int((unsigned char)c) << std::setw(0);
+            encoded.append(table.escapes + 3 * data[i], 3);
         }
     }
-
-    return escaped.str();
 }
 
 string StringUtils::UTF8Escape(const char* unicodeString, const char* delimiter)
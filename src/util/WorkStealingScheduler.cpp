@@ -0,0 +1,179 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "jdcloud_signer/util/WorkStealingScheduler.h"
+
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace jdcloud_signer {
+
+namespace {
+
+/**
+ * The indexes [begin, end) a worker still has to run. The owner pops from the front, thieves split off the back.
+ */
+struct WorkRange
+{
+    mutex lock;
+    size_t begin;
+    size_t end;
+
+    bool PopFront(size_t& index)
+    {
+        lock_guard<mutex> guard(lock);
+        if (begin == end)
+        {
+            return false;
+        }
+        index = begin++;
+        return true;
+    }
+
+    size_t Remaining()
+    {
+        lock_guard<mutex> guard(lock);
+        return end - begin;
+    }
+
+    bool StealBack(size_t& stolenBegin, size_t& stolenEnd)
+    {
+        lock_guard<mutex> guard(lock);
+        size_t remaining = end - begin;
+        if (remaining == 0)
+        {
+            return false;
+        }
+        // leave the owner the item it is most likely to pop next, take the back half.
+        size_t take = remaining / 2 > 0 ? remaining / 2 : remaining;
+        stolenEnd = end;
+        end -= take;
+        stolenBegin = end;
+        return true;
+    }
+
+    void Reset(size_t newBegin, size_t newEnd)
+    {
+        lock_guard<mutex> guard(lock);
+        begin = newBegin;
+        end = newEnd;
+    }
+};
+
+bool StealWork(vector<unique_ptr<WorkRange>>& ranges, size_t thief)
+{
+    while (true)
+    {
+        size_t victim = thief;
+        size_t mostRemaining = 0;
+        for (size_t i = 0; i < ranges.size(); ++i)
+        {
+            size_t remaining = i == thief ? 0 : ranges[i]->Remaining();
+            if (remaining > mostRemaining)
+            {
+                mostRemaining = remaining;
+                victim = i;
+            }
+        }
+
+        if (victim == thief)
+        {
+            return false;
+        }
+
+        size_t stolenBegin, stolenEnd;
+        if (ranges[victim]->StealBack(stolenBegin, stolenEnd))
+        {
+            ranges[thief]->Reset(stolenBegin, stolenEnd);
+            return true;
+        }
+        // the victim drained meanwhile, look again.
+    }
+}
+
+struct ThreadJoiner
+{
+    vector<thread> threads;
+
+    ~ThreadJoiner()
+    {
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+};
+
+void RunWorker(vector<unique_ptr<WorkRange>>& ranges, size_t worker, const WorkStealingScheduler::Task& task)
+{
+    size_t index;
+    do
+    {
+        while (ranges[worker]->PopFront(index))
+        {
+            task(worker, index);
+        }
+    } while (StealWork(ranges, worker));
+}
+
+}
+
+void WorkStealingScheduler::Run(size_t count, size_t workerCount, const Task& task)
+{
+    if (workerCount > count)
+    {
+        workerCount = count;
+    }
+
+    if (workerCount <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            task(0, i);
+        }
+        return;
+    }
+
+    vector<unique_ptr<WorkRange>> ranges;
+    for (size_t worker = 0; worker < workerCount; ++worker)
+    {
+        unique_ptr<WorkRange> range(new WorkRange);
+        range->begin = count * worker / workerCount;
+        range->end = count * (worker + 1) / workerCount;
+        ranges.push_back(move(range));
+    }
+
+    //declared after ranges, so the workers are joined before what they use goes away, exceptions included.
+    ThreadJoiner threads;
+    for (size_t worker = 1; worker < workerCount; ++worker)
+    {
+        try
+        {
+            threads.threads.emplace_back(RunWorker, ref(ranges), worker, cref(task));
+        }
+        catch (const system_error&)
+        {
+            //out of threads: the shares of the workers that did not start get stolen by the others.
+            break;
+        }
+    }
+    RunWorker(ranges, 0, task);
+}
+
+}
@@ -15,24 +15,194 @@
 // NOTE: This file is modified from AWS V4 Signer algorithm.
 
 #include "jdcloud_signer/util/crypto/HashingUtils.h"
-#include <sstream>
-#include <iomanip>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define JDCLOUD_SIGNER_X86_HEX_KERNELS
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
 namespace jdcloud_signer {
 
+namespace {
+
+// every byte value next to its two hex digits, so the scalar loop does one lookup per byte.
+struct HexTable
+{
+    HexTable()
+    {
+        static const char DIGITS[] = "0123456789abcdef";
+        for (int i = 0; i < 256; ++i)
+        {
+            pairs[2 * i] = DIGITS[i >> 4];
+            pairs[2 * i + 1] = DIGITS[i & 0x0f];
+            values[i] = -1;
+        }
+        for (int i = 0; i < 10; ++i)
+        {
+            values['0' + i] = static_cast<signed char>(i);
+        }
+        for (int i = 0; i < 6; ++i)
+        {
+            values['a' + i] = static_cast<signed char>(10 + i);
+            values['A' + i] = static_cast<signed char>(10 + i);
+        }
+    }
+
+    char pairs[512];
+    signed char values[256];
+};
+
+// built on first use, hex encoding may run while other globals are being initialized.
+const HexTable& GetHexTable()
+{
+    static const HexTable table;
+    return table;
+}
+
+void HexEncodeScalar(const unsigned char* message, size_t length, char* hex)
+{
+    const HexTable& hexTable = GetHexTable();
+    for (size_t i = 0; i < length; ++i)
+    {
+        const char* pair = hexTable.pairs + 2 * message[i];
+        hex[2 * i] = pair[0];
+        hex[2 * i + 1] = pair[1];
+    }
+}
+
+#ifdef JDCLOUD_SIGNER_X86_HEX_KERNELS
+// both kernels split each byte into nibbles, look the digits up with a byte shuffle and interleave high and low.
+
+__attribute__((target("ssse3")))
+void HexEncodeSSSE3(const unsigned char* message, size_t length, char* hex)
+{
+    const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                         '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m128i mask = _mm_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(message + i));
+        __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+        __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(bytes, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(hex + 2 * i), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(hex + 2 * i + 16), _mm_unpackhi_epi8(high, low));
+    }
+    HexEncodeScalar(message + i, length - i, hex + 2 * i);
+}
+
+__attribute__((target("avx2")))
+void HexEncodeAVX2(const unsigned char* message, size_t length, char* hex)
+{
+    const __m256i digits = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                            '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                            '0', '1', '2', '3', '4', '5', '6', '7',
+                                            '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(message + i));
+        __m256i high = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask));
+        __m256i low = _mm256_shuffle_epi8(digits, _mm256_and_si256(bytes, mask));
+        // unpack works within 128 bit lanes: lo holds bytes 0-7 and 16-23, hi holds 8-15 and 24-31.
+        __m256i lo = _mm256_unpacklo_epi8(high, low);
+        __m256i hi = _mm256_unpackhi_epi8(high, low);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(hex + 2 * i), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(hex + 2 * i + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    HexEncodeSSSE3(message + i, length - i, hex + 2 * i);
+}
+#endif
+
+HexKernel DetectHexKernel()
+{
+#ifdef JDCLOUD_SIGNER_X86_HEX_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return HexKernel::AVX2;
+    }
+    if (__builtin_cpu_supports("ssse3"))
+    {
+        return HexKernel::SSSE3;
+    }
+#endif
+    return HexKernel::Scalar;
+}
+
+}
+
 string HashingUtils::HexEncode(const unsigned char* message, size_t length)
 {
-    std::stringstream ss;
+    string hex(2 * length, '\0');
+    HexEncode(message, length, &hex[0]);
+    return hex;
+}
+
+void HashingUtils::HexEncode(const unsigned char* message, size_t length, char* hex)
+{
+    HexEncode(message, length, hex, GetHexKernel());
+}
 
-    for (unsigned i = 0; i < length; ++i)
+void HashingUtils::HexEncode(const unsigned char* message, size_t length, char* hex, HexKernel kernel)
+{
+    if (!IsHexKernelSupported(kernel))
     {
-        ss << std::hex << std::setw(2) << std::setfill('0')
-            << (unsigned int) message[i];
+        kernel = HexKernel::Scalar;
     }
 
-    return ss.str();
+    switch (kernel)
+    {
+#ifdef JDCLOUD_SIGNER_X86_HEX_KERNELS
+    case HexKernel::AVX2:
+        HexEncodeAVX2(message, length, hex);
+        break;
+    case HexKernel::SSSE3:
+        HexEncodeSSSE3(message, length, hex);
+        break;
+#endif
+    default:
+        HexEncodeScalar(message, length, hex);
+        break;
+    }
+}
+
+bool HashingUtils::HexDecode(const char* hex, size_t length, unsigned char* message)
+{
+    if (length % 2 != 0)
+    {
+        return false;
+    }
+
+    const HexTable& hexTable = GetHexTable();
+    for (size_t i = 0; i < length; i += 2)
+    {
+        signed char high = hexTable.values[static_cast<unsigned char>(hex[i])];
+        signed char low = hexTable.values[static_cast<unsigned char>(hex[i + 1])];
+        if (high < 0 || low < 0)
+        {
+            return false;
+        }
+        message[i / 2] = static_cast<unsigned char>((high << 4) | low);
+    }
+    return true;
+}
+
+bool HashingUtils::IsHexKernelSupported(HexKernel kernel)
+{
+    // each kernel needs a superset of the CPU features of the ones before it.
+    return static_cast<int>(kernel) <= static_cast<int>(GetHexKernel());
+}
+
+HexKernel HashingUtils::GetHexKernel()
+{
+    static const HexKernel best = DetectHexKernel();
+    return best;
 }
 
 }
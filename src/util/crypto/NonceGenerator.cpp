@@ -0,0 +1,155 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "jdcloud_signer/util/crypto/NonceGenerator.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <openssl/rand.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#ifndef WIN32
+#include <pthread.h>
+#endif
+#include "jdcloud_signer/util/crypto/HashingUtils.h"
+
+using namespace std;
+
+namespace jdcloud_signer {
+
+const size_t NonceGenerator::NONCE_LENGTH;
+const size_t NonceGenerator::BUFFER_LENGTH;
+
+namespace {
+
+// bumped in every forked child, a thread buffer filled under an older generation is thrown away.
+atomic<uint32_t> forkGeneration(0);
+
+#ifndef WIN32
+void OnFork()
+{
+    forkGeneration.fetch_add(1, memory_order_relaxed);
+}
+#endif
+
+void RegisterForkHandler()
+{
+#ifndef WIN32
+    static once_flag registered;
+    call_once(registered, []() {
+        pthread_atfork(nullptr, nullptr, OnFork);
+    });
+#endif
+}
+
+bool FillRandom(unsigned char* buffer, size_t length)
+{
+#if defined(__linux__) && defined(SYS_getrandom)
+    // the syscall directly, glibc only has a getrandom wrapper since 2.25.
+    size_t filled = 0;
+    while (filled < length)
+    {
+        long got = syscall(SYS_getrandom, buffer + filled, length - filled, 0);
+        if (got < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        filled += static_cast<size_t>(got);
+    }
+    if (filled == length)
+    {
+        return true;
+    }
+#endif
+    return RAND_bytes(buffer, static_cast<int>(length)) == 1;
+}
+
+struct NonceBuffer
+{
+    NonceBuffer() :
+        used(NonceGenerator::BUFFER_LENGTH),
+        generation(0)
+    {
+    }
+
+    unsigned char bytes[NonceGenerator::BUFFER_LENGTH];
+    size_t used;
+    uint32_t generation;
+};
+
+thread_local NonceBuffer nonceBuffer;
+
+}
+
+bool NonceGenerator::Generate(unsigned char* nonces, size_t count)
+{
+    RegisterForkHandler();
+
+    NonceBuffer& buffer = nonceBuffer;
+    uint32_t generation = forkGeneration.load(memory_order_relaxed);
+    if (buffer.generation != generation)
+    {
+        buffer.used = BUFFER_LENGTH;
+        buffer.generation = generation;
+    }
+
+    size_t length = count * NONCE_LENGTH;
+    // batches bigger than the buffer skip it.
+    if (length > BUFFER_LENGTH)
+    {
+        return FillRandom(nonces, length);
+    }
+
+    while (length > 0)
+    {
+        if (buffer.used == BUFFER_LENGTH)
+        {
+            if (!FillRandom(buffer.bytes, BUFFER_LENGTH))
+            {
+                return false;
+            }
+            buffer.used = 0;
+        }
+
+        size_t take = BUFFER_LENGTH - buffer.used < length ? BUFFER_LENGTH - buffer.used : length;
+        memcpy(nonces, buffer.bytes + buffer.used, take);
+        // handed out bytes are not kept around.
+        memset(buffer.bytes + buffer.used, 0, take);
+        buffer.used += take;
+        nonces += take;
+        length -= take;
+    }
+    return true;
+}
+
+string NonceGenerator::GenerateHex()
+{
+    unsigned char nonce[NONCE_LENGTH];
+    if (!Generate(nonce))
+    {
+        return string();
+    }
+    return HashingUtils::HexEncode(nonce, NONCE_LENGTH);
+}
+
+}
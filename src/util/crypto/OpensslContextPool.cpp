@@ -0,0 +1,92 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "jdcloud_signer/util/crypto/OpensslContextPool.h"
+
+#include <cassert>
+
+namespace jdcloud_signer {
+
+namespace {
+
+struct ThreadContexts
+{
+    ThreadContexts() :
+        digest(nullptr),
+        hmac(nullptr)
+    {
+    }
+
+    ~ThreadContexts()
+    {
+        if (digest)
+        {
+            EVP_MD_CTX_destroy(digest);
+        }
+        if (hmac)
+        {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+            HMAC_CTX_cleanup(hmac);
+            delete hmac;
+#else
+            HMAC_CTX_free(hmac);
+#endif
+        }
+    }
+
+    EVP_MD_CTX* digest;
+    HMAC_CTX* hmac;
+};
+
+thread_local ThreadContexts threadContexts;
+
+}
+
+const EVP_MD* OpensslContextPool::GetSha256()
+{
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    // fetched once and kept for the life of the process.
+    static const EVP_MD* sha256 = EVP_MD_fetch(nullptr, "SHA256", nullptr);
+    return sha256 ? sha256 : EVP_sha256();
+#else
+    return EVP_sha256();
+#endif
+}
+
+EVP_MD_CTX* OpensslContextPool::GetDigestContext()
+{
+    if (!threadContexts.digest)
+    {
+        threadContexts.digest = EVP_MD_CTX_create();
+        assert(threadContexts.digest != nullptr);
+    }
+    return threadContexts.digest;
+}
+
+HMAC_CTX* OpensslContextPool::GetHMACContext()
+{
+    if (!threadContexts.hmac)
+    {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+        threadContexts.hmac = new HMAC_CTX;
+        HMAC_CTX_init(threadContexts.hmac);
+#else
+        threadContexts.hmac = HMAC_CTX_new();
+#endif
+        assert(threadContexts.hmac != nullptr);
+    }
+    return threadContexts.hmac;
+}
+
+}
@@ -17,57 +17,55 @@
 #include "jdcloud_signer/util/crypto/Sha256.h"
 #include <openssl/sha.h>
 #include <openssl/evp.h>
-#include "jdcloud_signer/util/crypto/HashingUtils.h"
+#include "jdcloud_signer/util/crypto/OpensslContextPool.h"
 #include "jdcloud_signer/logging/LogMacros.h"
 
 namespace jdcloud_signer {
 
-class OpensslCtxRAIIGuard
+Sha256::Sha256() :
+    m_ctx(nullptr)
 {
-public:
-    OpensslCtxRAIIGuard()
-    {
-        m_ctx = EVP_MD_CTX_create();
-        assert(m_ctx != nullptr);
-    }
+}
 
-    ~OpensslCtxRAIIGuard()
+Sha256::~Sha256()
+{
+    if (m_ctx)
     {
         EVP_MD_CTX_destroy(m_ctx);
-        m_ctx = nullptr;
     }
+}
 
-    EVP_MD_CTX* getResource()
-    {
-        return m_ctx;
-    }
-private:
-    EVP_MD_CTX *m_ctx;
-};
+Sha256::Sha256(const Sha256&) :
+    m_ctx(nullptr)
+{
+}
+
+Sha256& Sha256::operator=(const Sha256&)
+{
+    return *this;
+}
 
 HashResult Sha256::Calculate(const std::string& str)
 {
-    OpensslCtxRAIIGuard guard;
-    auto ctx = guard.getResource();
-    EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr);
-    EVP_DigestUpdate(ctx, str.c_str(), str.size());
-
-    size_t length = (size_t)EVP_MD_size(EVP_sha256());
-    auto hash = (unsigned char*)malloc(length);
-    memset(hash, 0, length);
-    EVP_DigestFinal(ctx, hash, nullptr);
-
-    std::string result = HashingUtils::HexEncode(hash, length);
-    free(hash);
-    return HashResult(result);
+    return Calculate(str.data(), str.size());
 }
 
-HashResult Sha256::Calculate(std::istream& stream)
+HashResult Sha256::Calculate(const char* data, size_t length)
 {
-    OpensslCtxRAIIGuard guard;
-    auto ctx = guard.getResource();
+    EVP_MD_CTX* ctx = OpensslContextPool::GetDigestContext();
+    EVP_DigestInit_ex(ctx, OpensslContextPool::GetSha256(), nullptr);
+    EVP_DigestUpdate(ctx, data, length);
+
+    Sha256Digest digest;
+    EVP_DigestFinal_ex(ctx, digest.data(), nullptr);
+
+    return HashResult(digest);
+}
 
-    EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr);
+HashResult Sha256::Calculate(std::istream& stream)
+{
+    EVP_MD_CTX* ctx = OpensslContextPool::GetDigestContext();
+    EVP_DigestInit_ex(ctx, OpensslContextPool::GetSha256(), nullptr);
 
     auto currentPos = stream.tellg();
     if ((int)currentPos == -1)
@@ -94,14 +92,36 @@ HashResult Sha256::Calculate(std::istream& stream)
     stream.clear();
     stream.seekg(currentPos, stream.beg);
 
-    size_t length = (size_t)EVP_MD_size(EVP_sha256());
-    auto hash = (unsigned char*)malloc(length);
-    memset(hash, 0, length);
-    EVP_DigestFinal(ctx, hash, nullptr);
+    Sha256Digest digest;
+    EVP_DigestFinal_ex(ctx, digest.data(), nullptr);
+
+    return HashResult(digest);
+}
+
+void Sha256::Begin()
+{
+    if (!m_ctx)
+    {
+        m_ctx = EVP_MD_CTX_create();
+        assert(m_ctx != nullptr);
+    }
+    EVP_DigestInit_ex(m_ctx, OpensslContextPool::GetSha256(), nullptr);
+}
+
+void Sha256::Update(const char* data, size_t length)
+{
+    EVP_DigestUpdate(m_ctx, data, length);
+}
+
+HashResult Sha256::Finish()
+{
+    Sha256Digest digest;
+    if (!m_ctx || EVP_DigestFinal_ex(m_ctx, digest.data(), nullptr) != 1)
+    {
+        return HashResult(false);
+    }
 
-    std::string result = HashingUtils::HexEncode(hash, length);
-    free(hash);
-    return HashResult(result);
+    return HashResult(digest);
 }
 
 }
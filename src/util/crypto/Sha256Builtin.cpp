@@ -0,0 +1,180 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "jdcloud_signer/util/crypto/Sha256Builtin.h"
+
+#include <cstring>
+
+namespace jdcloud_signer {
+
+static const uint32_t INITIAL_STATE[SHA256_DIGEST_WORDS] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint32_t ROUND_CONSTANTS[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t RotateRight(uint32_t value, unsigned bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+static inline uint32_t LoadBigEndian(const unsigned char* p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+static inline void StoreBigEndian(unsigned char* p, uint32_t value)
+{
+    p[0] = (unsigned char)(value >> 24);
+    p[1] = (unsigned char)(value >> 16);
+    p[2] = (unsigned char)(value >> 8);
+    p[3] = (unsigned char)value;
+}
+
+Sha256Builtin::Sha256Builtin()
+{
+    Init();
+}
+
+void Sha256Builtin::Init()
+{
+    Init(INITIAL_STATE, 0);
+}
+
+void Sha256Builtin::Init(const uint32_t* state, uint64_t bytesHashed)
+{
+    memcpy(m_state, state, sizeof(m_state));
+    m_bytesHashed = bytesHashed;
+    m_bufferLength = 0;
+}
+
+void Sha256Builtin::Update(const unsigned char* data, size_t length)
+{
+    m_bytesHashed += length;
+
+    if (m_bufferLength > 0)
+    {
+        size_t toCopy = SHA256_BLOCK_LENGTH - m_bufferLength;
+        if (toCopy > length)
+        {
+            toCopy = length;
+        }
+        memcpy(m_buffer + m_bufferLength, data, toCopy);
+        m_bufferLength += toCopy;
+        data += toCopy;
+        length -= toCopy;
+
+        if (m_bufferLength < SHA256_BLOCK_LENGTH)
+        {
+            return;
+        }
+        Compress(m_buffer);
+        m_bufferLength = 0;
+    }
+
+    while (length >= SHA256_BLOCK_LENGTH)
+    {
+        Compress(data);
+        data += SHA256_BLOCK_LENGTH;
+        length -= SHA256_BLOCK_LENGTH;
+    }
+
+    memcpy(m_buffer, data, length);
+    m_bufferLength = length;
+}
+
+void Sha256Builtin::Final(unsigned char* digest)
+{
+    uint64_t bitLength = m_bytesHashed * 8;
+
+    m_buffer[m_bufferLength++] = 0x80;
+    if (m_bufferLength > SHA256_BLOCK_LENGTH - 8)
+    {
+        memset(m_buffer + m_bufferLength, 0, SHA256_BLOCK_LENGTH - m_bufferLength);
+        Compress(m_buffer);
+        m_bufferLength = 0;
+    }
+    memset(m_buffer + m_bufferLength, 0, SHA256_BLOCK_LENGTH - 8 - m_bufferLength);
+    StoreBigEndian(m_buffer + SHA256_BLOCK_LENGTH - 8, (uint32_t)(bitLength >> 32));
+    StoreBigEndian(m_buffer + SHA256_BLOCK_LENGTH - 4, (uint32_t)bitLength);
+    Compress(m_buffer);
+    m_bufferLength = 0;
+
+    for (size_t i = 0; i < SHA256_DIGEST_WORDS; ++i)
+    {
+        StoreBigEndian(digest + i * 4, m_state[i]);
+    }
+}
+
+void Sha256Builtin::GetState(uint32_t* state) const
+{
+    memcpy(state, m_state, sizeof(m_state));
+}
+
+void Sha256Builtin::Compress(const unsigned char* block)
+{
+    uint32_t w[64];
+    for (size_t i = 0; i < 16; ++i)
+    {
+        w[i] = LoadBigEndian(block + i * 4);
+    }
+    for (size_t i = 16; i < 64; ++i)
+    {
+        uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+    uint32_t e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+
+    for (size_t i = 0; i < 64; ++i)
+    {
+        uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + ch + ROUND_CONSTANTS[i] + w[i];
+        uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    m_state[0] += a;
+    m_state[1] += b;
+    m_state[2] += c;
+    m_state[3] += d;
+    m_state[4] += e;
+    m_state[5] += f;
+    m_state[6] += g;
+    m_state[7] += h;
+}
+
+}
@@ -0,0 +1,36 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "jdcloud_signer/util/crypto/Sha256Digest.h"
+
+#include "jdcloud_signer/util/crypto/HashingUtils.h"
+
+using namespace std;
+
+namespace jdcloud_signer {
+
+const size_t Sha256Digest::LENGTH;
+const size_t Sha256HexDigest::LENGTH;
+
+string Sha256Digest::ToHexString() const
+{
+    return Sha256HexDigest(*this).ToString();
+}
+
+Sha256HexDigest::Sha256HexDigest(const Sha256Digest& digest)
+{
+    HashingUtils::HexEncode(digest.data(), digest.size(), m_hex);
+}
+
+}
@@ -17,61 +17,33 @@
 #include "jdcloud_signer/util/crypto/Sha256HMAC.h"
 
 #include <openssl/hmac.h>
-#include "jdcloud_signer/util/crypto/HashingUtils.h"
+#include "jdcloud_signer/util/crypto/OpensslContextPool.h"
 
 using namespace std;
 
 namespace jdcloud_signer {
 
-class HMACRAIIGuard {
-public:
-    HMACRAIIGuard()
-    {
-#if OPENSSL_VERSION_NUMBER < 0x10100000L
-        m_ctx = new HMAC_CTX;
-        HMAC_CTX_init(m_ctx);
-#else
-        m_ctx = HMAC_CTX_new();
-#endif
-        assert(m_ctx != nullptr);
-    }
-
-    ~HMACRAIIGuard()
-    {
-#if OPENSSL_VERSION_NUMBER < 0x10100000L
-        HMAC_CTX_cleanup(m_ctx);
-        delete m_ctx;
-#else
-        HMAC_CTX_free(m_ctx);
-#endif
-        m_ctx = nullptr;
-    }
-
-    HMAC_CTX* getResource() {
-        return m_ctx;
-    }
-
-private:
-    HMAC_CTX *m_ctx;
-};
-
 HashResult Sha256HMAC::Calculate(const string& toSign, const string& secret)
 {
-    unsigned int length = 64;
-    auto digest = (unsigned char*)malloc(length);
-    memset(digest, 0, length);
+    return Calculate(toSign.data(), toSign.size(), (const unsigned char*)secret.data(), secret.size());
+}
 
-    HMACRAIIGuard guard;
-    HMAC_CTX* m_ctx = guard.getResource();
+HashResult Sha256HMAC::Calculate(const string& toSign, const Sha256Digest& key)
+{
+    return Calculate(toSign.data(), toSign.size(), key.data(), key.size());
+}
 
-    HMAC_Init_ex(m_ctx, secret.c_str(), static_cast<int>(secret.size()), EVP_sha256(), NULL);
-    HMAC_Update(m_ctx, (unsigned char*)toSign.c_str(), toSign.size());
-    HMAC_Final(m_ctx, digest, &length);
+HashResult Sha256HMAC::Calculate(const char* data, size_t length, const unsigned char* key, size_t keyLength)
+{
+    Sha256Digest digest;
+    unsigned int digestLength = 0;
 
-    string result((const char*) digest, length);
-    free(digest);
+    HMAC_CTX* ctx = OpensslContextPool::GetHMACContext();
+    HMAC_Init_ex(ctx, key, static_cast<int>(keyLength), OpensslContextPool::GetSha256(), NULL);
+    HMAC_Update(ctx, (const unsigned char*)data, length);
+    HMAC_Final(ctx, digest.data(), &digestLength);
 
-    return HashResult(result);
+    return HashResult(digest);
 }
 
 }
@@ -0,0 +1,152 @@
+// Copyright 2018 JDCLOUD.COM
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// SHA256_CTX is deprecated in OpenSSL 3 but it is still the only way to resume a digest from a raw state.
+#define OPENSSL_SUPPRESS_DEPRECATED
+
+#include "jdcloud_signer/util/crypto/Sha256HMACMidstate.h"
+
+#include <cstring>
+#include <openssl/sha.h>
+
+using namespace std;
+
+namespace jdcloud_signer {
+
+static const unsigned char IPAD = 0x36;
+static const unsigned char OPAD = 0x5c;
+
+#if defined(OPENSSL_NO_DEPRECATED_3_0)
+#define JDCLOUD_SIGNER_NO_OPENSSL_SHA256_CTX
+#endif
+
+Sha256HMACMidstate::Sha256HMACMidstate() :
+    m_valid(false)
+{
+    memset(m_inner, 0, sizeof(m_inner));
+    memset(m_outer, 0, sizeof(m_outer));
+}
+
+Sha256HMACMidstate::Sha256HMACMidstate(const string& secret) :
+    m_valid(true)
+{
+    Init((const unsigned char*)secret.data(), secret.size());
+}
+
+Sha256HMACMidstate::Sha256HMACMidstate(const Sha256Digest& key) :
+    m_valid(true)
+{
+    Init(key.data(), key.size());
+}
+
+void Sha256HMACMidstate::Init(const unsigned char* secret, size_t length)
+{
+    unsigned char key[SHA256_BLOCK_LENGTH] = {0};
+    if (length > SHA256_BLOCK_LENGTH)
+    {
+        Sha256Builtin keyHash;
+        keyHash.Update(secret, length);
+        keyHash.Final(key);
+    }
+    else
+    {
+        memcpy(key, secret, length);
+    }
+
+    unsigned char pad[SHA256_BLOCK_LENGTH];
+    Sha256Builtin sha;
+
+    for (size_t i = 0; i < SHA256_BLOCK_LENGTH; ++i)
+    {
+        pad[i] = key[i] ^ IPAD;
+    }
+    sha.Init();
+    sha.Update(pad, SHA256_BLOCK_LENGTH);
+    sha.GetState(m_inner);
+
+    for (size_t i = 0; i < SHA256_BLOCK_LENGTH; ++i)
+    {
+        pad[i] = key[i] ^ OPAD;
+    }
+    sha.Init();
+    sha.Update(pad, SHA256_BLOCK_LENGTH);
+    sha.GetState(m_outer);
+}
+
+Sha256HMACMidstate::Sha256HMACMidstate(const uint32_t* innerState, const uint32_t* outerState) :
+    m_valid(true)
+{
+    memcpy(m_inner, innerState, sizeof(m_inner));
+    memcpy(m_outer, outerState, sizeof(m_outer));
+}
+
+#ifndef JDCLOUD_SIGNER_NO_OPENSSL_SHA256_CTX
+static void ResumeOpensslSha256(SHA256_CTX& ctx, const uint32_t* state)
+{
+    SHA256_Init(&ctx);
+    for (size_t i = 0; i < SHA256_DIGEST_WORDS; ++i)
+    {
+        ctx.h[i] = state[i];
+    }
+    // one block (ipad or opad) is already in the state; Nl counts bits.
+    ctx.Nl = SHA256_BLOCK_LENGTH * 8;
+    ctx.Nh = 0;
+}
+#endif
+
+HashResult Sha256HMACMidstate::Calculate(const string& toSign, Sha256Implementation implementation) const
+{
+    return Calculate(toSign.data(), toSign.size(), implementation);
+}
+
+HashResult Sha256HMACMidstate::Calculate(const char* data, size_t length, Sha256Implementation implementation) const
+{
+    if (!m_valid)
+    {
+        return HashResult(false);
+    }
+
+    Sha256Digest digest;
+
+#ifndef JDCLOUD_SIGNER_NO_OPENSSL_SHA256_CTX
+    if (implementation == Sha256Implementation::OpenSSL)
+    {
+        SHA256_CTX ctx;
+        ResumeOpensslSha256(ctx, m_inner);
+        SHA256_Update(&ctx, data, length);
+        SHA256_Final(digest.data(), &ctx);
+
+        ResumeOpensslSha256(ctx, m_outer);
+        SHA256_Update(&ctx, digest.data(), digest.size());
+        SHA256_Final(digest.data(), &ctx);
+
+        return HashResult(digest);
+    }
+#else
+    (void)implementation;
+#endif
+
+    Sha256Builtin sha;
+    sha.Init(m_inner, SHA256_BLOCK_LENGTH);
+    sha.Update((const unsigned char*)data, length);
+    sha.Final(digest.data());
+
+    sha.Init(m_outer, SHA256_BLOCK_LENGTH);
+    sha.Update(digest.data(), digest.size());
+    sha.Final(digest.data());
+
+    return HashResult(digest);
+}
+
+}